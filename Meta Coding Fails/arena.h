@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+
+// Bump allocator over a list of mmapped chunks. Allocation is a pointer
+// bump, reset() is O(1) and keeps every chunk for the next round, and the
+// arena grows by doubling chunk size instead of overflowing a fixed buffer.
+// Chunks come straight from mmap, so they start zeroed and only the pages
+// actually touched become resident; nothing is memset up front.
+//
+// Nothing is destroyed on reset(), so only put trivially destructible
+// objects in it.
+class Arena {
+public:
+  explicit Arena(size_t first_chunk = 1 << 20, bool huge_pages = false)
+      : next_size(first_chunk), huge_pages(huge_pages) {}
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  ~Arena() {
+    for (Chunk &chunk : chunks)
+      munmap(chunk.base, chunk.size);
+  }
+
+  void *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+    for (;;) {
+      if (current < chunks.size()) {
+        Chunk &chunk = chunks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.base);
+        uintptr_t p = (base + used + align - 1) & ~(uintptr_t)(align - 1);
+        if (p + size <= base + chunk.size) {
+          used = p + size - base;
+          allocated += size;
+          return reinterpret_cast<void *>(p);
+        }
+        // Move on to a chunk kept from an earlier round, if any
+        current++;
+        used = 0;
+        continue;
+      }
+      add_chunk(size + align);
+    }
+  }
+
+  template <class T, class... Args> T *create(Args &&...args) {
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Forgets every allocation; chunks are kept for reuse
+  void reset() {
+    current = 0;
+    used = 0;
+    allocated = 0;
+  }
+
+  // Bytes handed out since the last reset
+  size_t bytes_allocated() const { return allocated; }
+
+  // Bytes mapped across all chunks
+  size_t bytes_reserved() const {
+    size_t total = 0;
+    for (const Chunk &chunk : chunks)
+      total += chunk.size;
+    return total;
+  }
+
+private:
+  struct Chunk {
+    void *base;
+    size_t size;
+  };
+
+  std::vector<Chunk> chunks;
+  size_t current = 0, used = 0, allocated = 0;
+  size_t next_size;
+  bool huge_pages;
+
+  void add_chunk(size_t at_least) {
+    size_t size = next_size;
+    while (size < at_least)
+      size *= 2;
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+      throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (huge_pages)
+      madvise(base, size, MADV_HUGEPAGE);
+#endif
+    chunks.push_back({base, size});
+    current = chunks.size() - 1;
+    used = 0;
+    next_size = size * 2;
+  }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+
+#include "arena.h"
+
+// std::pmr face for Arena, so standard containers can put their nodes in
+// it. Allocating is Arena's pointer bump and release() takes everything back
+// at once while keeping the chunks for the next round, like a
+// std::pmr::monotonic_buffer_resource whose buffer survives release().
+//
+// Unlike the monotonic resource, small freed blocks aren't lost: they go on
+// a free list per 16-byte size class and the next allocation of that class
+// pops one, so a tree that erases as much as it inserts stays the size of
+// its live nodes. That is all a node container needs from
+// std::pmr::unsynchronized_pool_resource, without its search for the chunk
+// that owns a freed block.
+class ArenaResource : public std::pmr::memory_resource {
+public:
+  explicit ArenaResource(size_t first_chunk = 1 << 20, bool huge_pages = false)
+      : arena(first_chunk, huge_pages) {}
+
+  // Only once nothing allocated here is in use any more
+  void release() {
+    arena.reset();
+    std::fill(std::begin(free_lists), std::end(free_lists), nullptr);
+  }
+
+  size_t bytes_allocated() const { return arena.bytes_allocated(); }
+  size_t bytes_reserved() const { return arena.bytes_reserved(); }
+
+private:
+  static constexpr size_t CLASS_BYTES = 16;
+  static constexpr size_t CLASSES = 16; // blocks up to 256 bytes
+
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  Arena arena;
+  FreeBlock *free_lists[CLASSES + 1] = {};
+
+  static bool recycled(size_t bytes, size_t align) {
+    return bytes <= CLASS_BYTES * CLASSES && align <= CLASS_BYTES;
+  }
+
+  static size_t size_class(size_t bytes) {
+    return (std::max(bytes, sizeof(FreeBlock)) + CLASS_BYTES - 1) /
+           CLASS_BYTES;
+  }
+
+  void *do_allocate(size_t bytes, size_t align) override {
+    if (!recycled(bytes, align))
+      return arena.allocate(bytes, align);
+    const size_t c = size_class(bytes);
+    if (FreeBlock *block = free_lists[c]) {
+      free_lists[c] = block->next;
+      return block;
+    }
+    return arena.allocate(c * CLASS_BYTES, CLASS_BYTES);
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t align) override {
+    if (!recycled(bytes, align))
+      return;
+    const size_t c = size_class(bytes);
+    free_lists[c] = new (p) FreeBlock{free_lists[c]};
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+};
+
+// Where the set and multiset variants put their tree nodes: a per-thread
+// arena, released here because nothing from the caller's last call is alive
+// any more, or with heap set every node's own operator new, which is what
+// the arena saves. One arena per thread, so calls on different threads don't
+// release each other's nodes. heap is an argument rather than a test of
+// PLUS_HEAP_NODES here because engines.h includes each variant twice, with
+// and without it, and this header only once.
+inline std::pmr::memory_resource *plus_node_resource(bool heap) {
+  if (heap)
+    return std::pmr::new_delete_resource();
+  thread_local ArenaResource arena;
+  arena.release();
+  return &arena;
+}
@@ -0,0 +1,96 @@
+// Counts a batch of drawings with BatchCounter (plus_batch.h).
+//
+//   g++ -std=c++17 -O2 -pthread -I. -o batch_count batch_count.cpp
+//   ./batch_count [drawings per shape] [strokes per drawing]
+//
+// Runs the usual three cases, then times a batch of generated drawings on
+// four threads and checks it against counts from freshly built lines.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "plus_batch.h"
+#include "plus_sign.h"
+
+using namespace std;
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  // Kept across calls, like a BatchCounter thread's scratch
+  static PlusScratch scratch;
+  Drawing d;
+  d.N = N;
+  d.L = move(L);
+  d.D = move(D);
+  return scratch.count(d);
+}
+
+// The sweep on new vectors, sharing nothing with PlusScratch, so a buffer
+// that a scratch reuses wrongly shows up as a mismatch
+static long long count_fresh(const Drawing &d) {
+  vector<Interval> vstrokes, hstrokes, vlines, hlines, scratch;
+  build_strokes(d.N, d.L, d.D, vstrokes, hstrokes);
+  sort_by_anchor_start(hstrokes, scratch);
+  merge_intervals(hstrokes, hlines);
+  sort_by_anchor_start(vstrokes, scratch);
+  merge_intervals(vstrokes, vlines);
+  return count_crossings_sweep(hlines, vlines);
+}
+
+int main(int argc, char **argv) {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  size_t per_shape = argc > 1 ? strtoull(argv[1], nullptr, 10) : 5000;
+  int strokes = argc > 2 ? atoi(argv[2]) : 200;
+  vector<Drawing> drawings;
+  uint64_t seed = 1;
+  for (Shape shape : all_shapes) {
+    for (size_t i = 0; i < per_shape; i++)
+      drawings.push_back(generate_drawing(shape, strokes, seed++));
+  }
+
+  // Four threads whatever the machine has, so the hand-off to the workers
+  // always runs
+  BatchCounter counter(4);
+  vector<long long> counts(drawings.size());
+  for (int round = 0; round < 2; round++) {
+    auto start = chrono::steady_clock::now();
+    counter.count(drawings.data(), drawings.size(), counts.data());
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() -
+                                                start)
+                    .count();
+    cout << "Batch of " << drawings.size() << " on " << counter.threads()
+         << " threads: " << ms << " ms\n";
+  }
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < drawings.size(); i++) {
+    const Drawing &d = drawings[i];
+    if (counts[i] != count_fresh(d))
+      mismatches++;
+  }
+  cout << "Mismatches against fresh counts: " << mismatches << "\n";
+  return mismatches != 0;
+}
@@ -0,0 +1,219 @@
+// Scaling benchmark over every getPlusSignCount variant in this directory.
+//
+//   g++ -std=c++17 -O2 -pthread -I. -o benchmark benchmark.cpp
+//   ./benchmark [--min-n 1000] [--max-n 2000000] [--timeout 30]
+//               [--only name,name] [--shapes name,name] [--seed 1]
+//               [--mem-mb 0] > bench_output.txt
+//
+// Add -DPLUS_STATS to also get the per-call JSON counters of plus_stats.h on
+// stderr.
+//
+// The variants come from the registry in engines.h, in its order, plus
+// "auto", which is getPlusSignCountAuto choosing an engine per drawing. Set
+// PLUS_ENGINE=name to pin what auto runs.
+//
+// Each measurement runs in a forked child. That gives a clean peak RSS per
+// run (wait4) and lets a timeout or crash be reported instead of taking the
+// suite down.
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "engines.h"
+
+using namespace std;
+
+// The registry's engines, then auto; the first is the reference the others
+// are checked against
+static vector<PlusEngine> benchmark_variants() {
+  vector<PlusEngine> variants = engine_registry().engines();
+  variants.push_back({"auto", getPlusSignCountAuto, true});
+  return variants;
+}
+
+struct Measurement {
+  long long result;
+  long long wall_ns;
+  long long input_rss_kb;
+};
+
+enum class Status { ok, timeout, crash, skipped };
+
+static const char *status_name(Status status) {
+  switch (status) {
+  case Status::ok:
+    return "ok";
+  case Status::timeout:
+    return "timeout";
+  case Status::crash:
+    return "crash";
+  case Status::skipped:
+    return "skipped";
+  }
+  return "?";
+}
+
+static long long now_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Runs one variant on one drawing in a child process
+static Status run_child(const PlusEngine &variant, Shape shape, int n,
+                        uint64_t seed, int timeout_s, long long mem_mb,
+                        Measurement &out, long long &peak_rss_kb) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    exit(1);
+  }
+  fflush(stdout);
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    if (mem_mb > 0) {
+      rlimit limit{(rlim_t)mem_mb << 20, (rlim_t)mem_mb << 20};
+      setrlimit(RLIMIT_AS, &limit);
+    }
+    Drawing d = generate_drawing(shape, n, seed);
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    Measurement m;
+    m.input_rss_kb = usage.ru_maxrss;
+    alarm(timeout_s);
+    long long start = now_ns();
+    m.result = variant.count(d.N, d.L, d.D);
+    m.wall_ns = now_ns() - start;
+    if (write(fds[1], &m, sizeof(m)) != sizeof(m))
+      _exit(2);
+    _exit(0);
+  }
+  close(fds[1]);
+
+  int wstatus = 0;
+  rusage usage;
+  wait4(pid, &wstatus, 0, &usage);
+  peak_rss_kb = usage.ru_maxrss;
+  bool got = read(fds[0], &out, sizeof(out)) == sizeof(out);
+  close(fds[0]);
+
+  if (WIFSIGNALED(wstatus) && WTERMSIG(wstatus) == SIGALRM)
+    return Status::timeout;
+  if (!got || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+    return Status::crash;
+  return Status::ok;
+}
+
+static vector<string> split(const string &list) {
+  vector<string> names;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == string::npos)
+      end = list.size();
+    if (end > start)
+      names.push_back(list.substr(start, end - start));
+    start = end + 1;
+  }
+  return names;
+}
+
+static bool selected(const vector<string> &names, const char *name) {
+  return names.empty() || find(names.begin(), names.end(), name) != names.end();
+}
+
+int main(int argc, char **argv) {
+  long long min_n = 1000, max_n = 2000000, mem_mb = 0;
+  int timeout_s = 30;
+  uint64_t seed = 1;
+  vector<string> only, only_shapes;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    string flag = argv[i];
+    if (flag == "--min-n")
+      min_n = atoll(argv[i + 1]);
+    else if (flag == "--max-n")
+      max_n = atoll(argv[i + 1]);
+    else if (flag == "--timeout")
+      timeout_s = atoi(argv[i + 1]);
+    else if (flag == "--only")
+      only = split(argv[i + 1]);
+    else if (flag == "--shapes")
+      only_shapes = split(argv[i + 1]);
+    else if (flag == "--seed")
+      seed = strtoull(argv[i + 1], nullptr, 10);
+    else if (flag == "--mem-mb")
+      mem_mb = atoll(argv[i + 1]);
+    else {
+      cerr << "unknown flag " << flag << "\n";
+      return 1;
+    }
+  }
+
+  // 1e3, 2e3, 5e3, 1e4, ... capped at max_n
+  vector<int> sizes;
+  for (long long decade = 1000; decade <= max_n; decade *= 10) {
+    for (long long step : {1, 2, 5}) {
+      long long n = decade * step;
+      if (n >= min_n && n <= max_n)
+        sizes.push_back(n);
+    }
+  }
+
+  const vector<PlusEngine> variants = benchmark_variants();
+  cout << "variant,shape,n,status,result,matches_reference,wall_ms,"
+          "strokes_per_sec,input_rss_kb,peak_rss_kb\n";
+  for (Shape shape : all_shapes) {
+    if (!selected(only_shapes, shape_name(shape)))
+      continue;
+    // Once a variant times out or crashes, larger inputs are skipped
+    vector<bool> gave_up(size(variants), false);
+    for (int n : sizes) {
+      bool have_reference = false;
+      long long reference = 0;
+      for (size_t v = 0; v < size(variants); v++) {
+        const PlusEngine &variant = variants[v];
+        if (v != 0 && !selected(only, variant.name))
+          continue;
+
+        Measurement m{};
+        long long peak_rss_kb = 0;
+        Status status = Status::skipped;
+        if (!gave_up[v])
+          status = run_child(variant, shape, n, seed, timeout_s, mem_mb, m,
+                             peak_rss_kb);
+        if (status == Status::timeout || status == Status::crash)
+          gave_up[v] = true;
+
+        if (v == 0 && status == Status::ok) {
+          have_reference = true;
+          reference = m.result;
+        }
+        if (v == 0 && !selected(only, variant.name))
+          continue;
+
+        cout << variant.name << "," << shape_name(shape) << "," << n << ","
+             << status_name(status) << ",";
+        if (status == Status::ok) {
+          double seconds = m.wall_ns / 1e9;
+          cout << m.result << ","
+               << (have_reference ? (m.result == reference ? "yes" : "no")
+                                  : "?")
+               << "," << m.wall_ns / 1e6 << ","
+               << (seconds > 0 ? (long long)(n / seconds) : 0) << ","
+               << m.input_rss_kb << "," << peak_rss_kb;
+        } else {
+          cout << ",,,,,";
+        }
+        cout << "\n";
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,305 @@
+// Counts plus signs straight from a binary drawing (drawing_bin.h). The file
+// is mapped and decoded in place, a range of chunks per thread, without
+// ever building L or D.
+//
+//   g++ -std=c++17 -O2 -pthread -I. -o binary_mmap binary_mmap.cpp
+//   ./binary_mmap drawing.bin [more.bin ...]
+//
+// With no arguments it runs the usual three cases through a temp file and
+// checks that a length past INT_MAX is refused, then times a generated
+// drawing loaded from text and from binary.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "drawing_bin.h"
+#include "drawing_gen.h"
+#include "parallel_merge.h"
+#include "plus_sign.h"
+
+using namespace std;
+
+// Steps decoded per build_strokes_range call
+constexpr size_t DECODE_BLOCK = 4096;
+
+// Strokes of a range of chunks, built as if the pen started at (0, 0)
+struct ChunkStrokes {
+  vector<Interval> vstrokes, hstrokes;
+  long long dx = 0, dy = 0;
+  bool ok = true;
+};
+
+// Appends src to dst. When the same direction is on both sides of the seam,
+// the run across it was cut in two; the halves are the last stroke of dst
+// and the first of src in that direction's orientation, and are joined.
+static void append_strokes(vector<Interval> &vdst, vector<Interval> &hdst,
+                           const vector<Interval> &vsrc,
+                           const vector<Interval> &hsrc, char before,
+                           char after) {
+  size_t skip_v = 0, skip_h = 0;
+  if (before == after) {
+    if (after == 'U' || after == 'D') {
+      vdst.back() = vdst.back().merge(vsrc[0]);
+      skip_v = 1;
+    } else {
+      hdst.back() = hdst.back().merge(hsrc[0]);
+      skip_h = 1;
+    }
+  }
+  vdst.insert(vdst.end(), vsrc.begin() + skip_v, vsrc.end());
+  hdst.insert(hdst.end(), hsrc.begin() + skip_h, hsrc.end());
+}
+
+// Decodes chunks [first, last) in blocks and runs build_strokes_range over
+// each one
+static void decode_part(const BinaryDrawingView &view, uint64_t first,
+                        uint64_t last, ChunkStrokes &part) {
+  int L[DECODE_BLOCK];
+  char D[DECODE_BLOCK];
+  size_t n = 0;
+  char before = 0;
+  vector<Interval> vblock, hblock;
+  auto flush = [&]() {
+    vblock.clear();
+    hblock.clear();
+    build_strokes_range(L, D, n, part.dx, part.dy, vblock, hblock);
+    append_strokes(part.vstrokes, part.hstrokes, vblock, hblock, before,
+                   D[0]);
+    for (size_t i = 0; i < n; i++) {
+      const DirectionStep step = direction_table.steps[(unsigned char)D[i]];
+      part.dx += step.dx * (long long)L[i];
+      part.dy += step.dy * (long long)L[i];
+    }
+    before = D[n - 1];
+    n = 0;
+  };
+  part.ok = view.decode(first, last, [&](char d, long long len) {
+    L[n] = len;
+    D[n++] = d;
+    if (n == DECODE_BLOCK)
+      flush();
+  });
+  if (n > 0)
+    flush();
+  view.release(first, last);
+}
+
+// Every thread decodes a range of chunks from the origin. A scan over the
+// ranges' net moves then gives each range its real start, and the strokes
+// are shifted there. Runs cut by a block or range edge are joined again, so
+// the result is exactly what build_strokes makes.
+bool decode_strokes(const BinaryDrawingView &view, unsigned threads,
+                    vector<Interval> &vstrokes, vector<Interval> &hstrokes) {
+  const uint64_t chunks = view.chunks();
+  const size_t parts = max<uint64_t>(1, min<uint64_t>(threads, chunks));
+  vector<uint64_t> edges(parts + 1);
+  for (size_t p = 0; p <= parts; p++)
+    edges[p] = chunks * p / parts;
+
+  vector<ChunkStrokes> out(parts);
+  vector<thread> workers;
+  for (size_t p = 1; p < parts; p++)
+    workers.emplace_back([&, p] {
+      decode_part(view, edges[p], edges[p + 1], out[p]);
+    });
+  decode_part(view, edges[0], edges[1], out[0]);
+  for (thread &worker : workers)
+    worker.join();
+
+  long long x = 0, y = 0;
+  for (size_t p = 0; p < parts; p++) {
+    ChunkStrokes &part = out[p];
+    if (!part.ok)
+      return false;
+    for (Interval &stroke : part.vstrokes) {
+      stroke.a += x;
+      stroke.s += y;
+      stroke.e += y;
+    }
+    for (Interval &stroke : part.hstrokes) {
+      stroke.a += y;
+      stroke.s += x;
+      stroke.e += x;
+    }
+    const uint64_t begin = view.chunk_begin(edges[p]);
+    if (vstrokes.empty() && hstrokes.empty()) {
+      vstrokes.swap(part.vstrokes);
+      hstrokes.swap(part.hstrokes);
+    } else if (begin < view.steps())
+      append_strokes(vstrokes, hstrokes, part.vstrokes, part.hstrokes,
+                     p > 0 ? view.direction(begin - 1) : 0,
+                     view.direction(begin));
+    x += part.dx;
+    y += part.dy;
+    vector<Interval>().swap(part.vstrokes);
+    vector<Interval>().swap(part.hstrokes);
+  }
+  return true;
+}
+
+// Returns -1 if the file can't be read or isn't a binary drawing
+long long getPlusSignCountFromBinary(const char *path) {
+  BinaryDrawingView view;
+  if (!view.open(path))
+    return -1;
+  const unsigned threads = thread::hardware_concurrency();
+  vector<Interval> vstrokes, hstrokes, vlines, hlines;
+  if (!decode_strokes(view, threads, vstrokes, hstrokes))
+    return -1;
+
+  sort_merge_parallel(hstrokes, hlines, threads);
+  sort_merge_parallel(vstrokes, vlines, threads);
+  return count_crossings_sweep(hlines, vlines);
+}
+
+static long long count_through_file(const Drawing &d,
+                                    uint32_t chunk_steps) {
+  char path[] = "/tmp/plus_drawing_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return -1;
+  close(fd);
+  {
+    ofstream out(path, ios::binary);
+    write_binary_drawing(out, d, chunk_steps);
+  }
+  long long result = getPlusSignCountFromBinary(path);
+  unlink(path);
+  return result;
+}
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  Drawing d;
+  d.N = N;
+  d.L = move(L);
+  d.D = move(D);
+  return count_through_file(d, BINARY_DRAWING_CHUNK);
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+      long long result = getPlusSignCountFromBinary(argv[i]);
+      if (result < 0) {
+        cerr << argv[i] << ": not a readable binary drawing\n";
+        status = 1;
+        continue;
+      }
+      cout << argv[i] << ": " << result << "\n";
+    }
+    return status;
+  }
+
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // A length of 2^31 is a format error, not a negative step: one step of
+  // 2^28, a five-byte varint, with its last byte patched from 1 to 8
+  {
+    Drawing bad;
+    bad.N = 1;
+    bad.L = {1 << 28};
+    bad.D = "U";
+    char bad_path[] = "/tmp/plus_drawing_XXXXXX";
+    int bad_fd = mkstemp(bad_path);
+    if (bad_fd < 0)
+      return 1;
+    close(bad_fd);
+    {
+      ofstream out(bad_path, ios::binary);
+      write_binary_drawing(out, bad);
+    }
+    {
+      fstream patch(bad_path, ios::binary | ios::in | ios::out);
+      patch.seekp(-1, ios::end);
+      patch.put(8);
+    }
+    expected = -1;
+    result = getPlusSignCountFromBinary(bad_path);
+    unlink(bad_path);
+    cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+  }
+
+  // Text against binary on one generated drawing
+  Drawing d = generate_drawing(Shape::random_walk, 10000000, 1);
+  char text_path[] = "/tmp/plus_drawing_XXXXXX";
+  char bin_path[] = "/tmp/plus_drawing_XXXXXX";
+  int text_fd = mkstemp(text_path), bin_fd = mkstemp(bin_path);
+  if (text_fd < 0 || bin_fd < 0)
+    return 1;
+  close(text_fd);
+  close(bin_fd);
+  {
+    ofstream text(text_path);
+    write_drawing(text, d);
+    ofstream bin(bin_path, ios::binary);
+    write_binary_drawing(bin, d);
+  }
+
+  // Loading is timed up to the strokes, where the two paths meet
+  auto start = chrono::steady_clock::now();
+  Drawing loaded;
+  {
+    ifstream text(text_path);
+    read_drawing(text, loaded);
+  }
+  vector<Interval> vstrokes, hstrokes;
+  build_strokes(loaded.N, loaded.L, loaded.D, vstrokes, hstrokes);
+  double text_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+
+  start = chrono::steady_clock::now();
+  BinaryDrawingView view;
+  vector<Interval> bin_vstrokes, bin_hstrokes;
+  bool decoded = view.open(bin_path) &&
+                 decode_strokes(view, thread::hardware_concurrency(),
+                                bin_vstrokes, bin_hstrokes);
+  double bin_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+
+  vector<Interval> vlines, hlines, scratch;
+  sort_by_anchor_start(hstrokes, scratch);
+  merge_intervals(hstrokes, hlines);
+  sort_by_anchor_start(vstrokes, scratch);
+  merge_intervals(vstrokes, vlines);
+  long long from_text = count_crossings_sweep(hlines, vlines);
+  long long from_binary = getPlusSignCountFromBinary(bin_path);
+  unlink(text_path);
+  unlink(bin_path);
+
+  cout << "Loaded " << d.N << " steps from text in " << text_ms
+       << " ms, from binary in " << bin_ms << " ms ("
+       << (decoded ? "same" : "failed") << "); counts " << from_text << " and "
+       << from_binary << "\n";
+  return !decoded || bin_vstrokes.size() != vstrokes.size() ||
+         from_text != from_binary;
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "plus_sign.h"
+#include "radix_sort.h"
+#include "work_stealing_pool.h"
+
+// count_crossings_sweep as a divide and conquer over time (CDQ) instead of a
+// Fenwick tree.
+//
+// The sweep is written out as a list of events in the order it would see
+// them: +1 at x when a vertical line starts, -1 when it ends, and for each
+// horizontal line two probes, -1 at s and +1 at e - 1. The count is the sum,
+// over every probe at t, of its sign times the weights seen earlier with
+// x <= t. Split the list in two: pairs inside a half are counted by
+// recursing, and pairs from the left half to the right one by merging both
+// halves sorted by x, adding up left weights and reading them off at right
+// probes. The merge leaves the range sorted by x for the level above, so
+// this is a merge sort doing O(n log n) work in sequential passes, with no
+// tree to chase and no tuning to a cache size.
+//
+// The halves are independent, so big ones are forked on a WorkStealingPool.
+// So are big merges: the output is cut in two at its middle, the split point
+// in each input found by co-ranking (a binary search for how many left items
+// come first), and each piece merged on its own. A piece's count misses only
+// the left weight merged before it, which is the first piece's weight total
+// times the second's probe signs, so the pieces add up with no prefix pass.
+
+struct CdqItem {
+  long long x;
+  int add; // weight of an update, 0 for a probe
+  int ask; // sign of a probe, 0 for an update
+};
+
+// Ranges at most this long are counted pair by pair
+constexpr size_t CDQ_LEAF = 32;
+// Ranges shorter than this aren't forked
+constexpr size_t CDQ_FORK_MIN = 1 << 15;
+
+namespace cdq_detail {
+
+// By x; at equal x, updates before probes, since a probe at t counts x <= t
+inline bool item_less(const CdqItem &l, const CdqItem &r) {
+  return l.x != r.x ? l.x < r.x : l.ask == 0 && r.ask != 0;
+}
+
+inline long long leaf(CdqItem *items, size_t n) {
+  long long sum = 0;
+  for (size_t j = 0; j < n; j++) {
+    if (items[j].ask == 0)
+      continue;
+    for (size_t i = 0; i < j; i++)
+      if (items[i].x <= items[j].x)
+        sum += (long long)items[j].ask * items[i].add;
+  }
+  for (size_t i = 1; i < n; i++) {
+    CdqItem item = items[i];
+    size_t j = i;
+    for (; j > 0 && item_less(item, items[j - 1]); j--)
+      items[j] = items[j - 1];
+    items[j] = item;
+  }
+  return sum;
+}
+
+// What merging a pair of runs leaves behind: the count, the left weight it
+// added up and the sum of the right probe signs
+struct MergeSum {
+  long long sum = 0, weight = 0, asks = 0;
+};
+
+// Merges two sorted runs into out and counts left updates against right
+// probes
+inline MergeSum merge(const CdqItem *l, size_t nl, const CdqItem *r,
+                      size_t nr, CdqItem *out) {
+  MergeSum m;
+  size_t i = 0, j = 0;
+  while (i < nl && j < nr) {
+    if (item_less(r[j], l[i])) {
+      m.sum += r[j].ask * m.weight;
+      m.asks += r[j].ask;
+      *out++ = r[j++];
+    } else {
+      m.weight += l[i].add;
+      *out++ = l[i++];
+    }
+  }
+  for (; i < nl; i++) {
+    m.weight += l[i].add;
+    *out++ = l[i];
+  }
+  for (; j < nr; j++) {
+    m.sum += r[j].ask * m.weight;
+    m.asks += r[j].ask;
+    *out++ = r[j];
+  }
+  return m;
+}
+
+// How many of the first p merged items come from l. Ties go to l, as in
+// merge.
+inline size_t co_rank(size_t p, const CdqItem *l, size_t nl,
+                      const CdqItem *r, size_t nr) {
+  size_t lo = p > nr ? p - nr : 0, hi = std::min(p, nl);
+  while (lo < hi) {
+    const size_t i = lo + (hi - lo) / 2;
+    if (item_less(r[p - i - 1], l[i]))
+      hi = i;
+    else
+      lo = i + 1;
+  }
+  return lo;
+}
+
+// merge, with outputs of CDQ_FORK_MIN or more split in two and forked
+inline MergeSum merge_parallel(const CdqItem *l, size_t nl, const CdqItem *r,
+                               size_t nr, CdqItem *out,
+                               WorkStealingPool *pool) {
+  const size_t n = nl + nr;
+  if (pool == nullptr || n < CDQ_FORK_MIN)
+    return merge(l, nl, r, nr, out);
+  const size_t i = co_rank(n / 2, l, nl, r, nr), j = n / 2 - i;
+  MergeSum first, second;
+  pool->fork_join(
+      [&] { first = merge_parallel(l, i, r, j, out, pool); },
+      [&] {
+        second = merge_parallel(l + i, nl - i, r + j, nr - j, out + n / 2,
+                                pool);
+      });
+  return {first.sum + second.sum + first.weight * second.asks,
+          first.weight + second.weight, first.asks + second.asks};
+}
+
+// Sorts items[0, n) by x, into buffer when to_buffer and in place otherwise,
+// and returns the count over the range
+inline long long solve(CdqItem *items, CdqItem *buffer, size_t n,
+                       bool to_buffer, WorkStealingPool *pool) {
+  if (n <= CDQ_LEAF) {
+    long long sum = leaf(items, n);
+    if (to_buffer)
+      std::copy(items, items + n, buffer);
+    return sum;
+  }
+  const size_t m = n / 2;
+  long long left = 0, right = 0;
+  auto solve_left = [&] { left = solve(items, buffer, m, !to_buffer, pool); };
+  auto solve_right = [&] {
+    right = solve(items + m, buffer + m, n - m, !to_buffer, pool);
+  };
+  if (pool != nullptr && n >= CDQ_FORK_MIN) {
+    pool->fork_join(solve_left, solve_right);
+  } else {
+    solve_left();
+    solve_right();
+  }
+  // The halves were sorted into the other array
+  const CdqItem *src = to_buffer ? items : buffer;
+  CdqItem *dst = to_buffer ? buffer : items;
+  return left + right +
+         merge_parallel(src, m, src + m, n - m, dst, pool).sum;
+}
+
+} // namespace cdq_detail
+
+// The sweep's events in the order count_crossings_sweep handles them: a
+// line starting at y is seen by a horizontal line above y, one ending at y
+// by horizontal lines at or above y
+inline void cdq_events(const std::vector<Interval> &hlines,
+                       const std::vector<Interval> &vlines,
+                       std::vector<CdqItem> &items) {
+  std::vector<std::pair<long long, long long>> starts, ends, scratch;
+  for (const Interval &vline : vlines) {
+    if (vline.s == vline.e)
+      continue; // nothing inside, and it would end before it starts
+    starts.emplace_back(vline.s, vline.a);
+    ends.emplace_back(vline.e, vline.a);
+  }
+  auto key = [](const std::pair<long long, long long> &event) {
+    return event.first;
+  };
+  radix_sort(starts, scratch, key);
+  radix_sort(ends, scratch, key);
+
+  items.clear();
+  size_t si = 0, ei = 0;
+  for (const Interval &hline : hlines) {
+    if (hline.e - hline.s < 2)
+      continue; // no integer strictly inside
+    for (; si < starts.size() && starts[si].first < hline.a; si++)
+      items.push_back({starts[si].second, 1, 0});
+    for (; ei < ends.size() && ends[ei].first <= hline.a; ei++)
+      items.push_back({ends[ei].second, -1, 0});
+    items.push_back({hline.s, 0, -1});
+    items.push_back({hline.e - 1, 0, 1});
+  }
+}
+
+// Lines merged as for count_crossings_sweep. With a pool, large halves and
+// merges run on its workers; the pool must not be inside another run().
+inline long long count_crossings_cdq(const std::vector<Interval> &hlines,
+                                     const std::vector<Interval> &vlines,
+                                     WorkStealingPool *pool = nullptr) {
+  if (hlines.empty() || vlines.empty())
+    return 0;
+  std::vector<CdqItem> items, buffer;
+  cdq_events(hlines, vlines, items);
+  buffer.resize(items.size());
+
+  long long nplus = 0;
+  auto count = [&] {
+    nplus = cdq_detail::solve(items.data(), buffer.data(), items.size(),
+                              false, pool);
+  };
+  if (pool != nullptr && pool->size() > 1)
+    pool->run(count);
+  else
+    count();
+  return nplus;
+}
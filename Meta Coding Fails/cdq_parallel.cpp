@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cdq_count.h"
+#include "parallel_merge.h"
+#include "parallel_strokes.h"
+#include "plus_sign.h"
+#include "work_stealing_pool.h"
+
+using namespace std;
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  const unsigned threads = thread::hardware_concurrency();
+  vector<Interval> vstrokes, hstrokes, vlines, hlines;
+  build_strokes_parallel(N, L, D, vstrokes, hstrokes, threads);
+
+  sort_merge_parallel(hstrokes, hlines, threads);
+  sort_merge_parallel(vstrokes, vlines, threads);
+
+  // One pool for the process, so its threads aren't started on every call.
+  // Concurrent calls take turns in run().
+  static WorkStealingPool pool(threads);
+  return count_crossings_cdq(hlines, vlines, &pool);
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "plus_sign.h"
+#include "radix_sort.h"
+
+// Strokes with 32-bit coordinates, 12 bytes instead of 24, for the sort,
+// merge and sweep. Whether a point is strictly inside a line, and whether
+// two lines touch, only depends on the order of coordinates, so any
+// order-preserving map to 32 bits gives the same count:
+//
+//   - when the drawing spans less than 2^32 on an axis (any drawing whose
+//     lengths sum below that), the map is c - min, found in one pass over L/D
+//     with no sorting;
+//   - otherwise the coordinates are replaced by their dense ranks.
+
+struct CompactInterval {
+  uint32_t a, s, e;
+};
+static_assert(sizeof(CompactInterval) == 12, "packed layout");
+
+// How compact coordinates map back: x = x_base + c, or xs[c] when xs isn't
+// empty; the same for y
+struct CoordinateMap {
+  long long x_base = 0, y_base = 0;
+  std::vector<long long> xs, ys;
+
+  long long x(uint32_t c) const { return xs.empty() ? x_base + c : xs[c]; }
+  long long y(uint32_t c) const { return ys.empty() ? y_base + c : ys[c]; }
+};
+
+// Steps per build_strokes_range call; strokes go straight to compact form
+// one block at a time, so the 24-byte strokes never exist all at once
+constexpr size_t COMPACT_BLOCK = 1 << 16;
+
+// Dense ranks of a list of coordinates, for drawings too wide for an offset
+inline void rank_coordinates(std::vector<long long> &coords,
+                             std::vector<long long> &sorted) {
+  std::vector<long long> scratch;
+  sorted = coords;
+  radix_sort(sorted, scratch, [](long long c) { return c; });
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  for (long long &c : coords)
+    c = std::lower_bound(sorted.begin(), sorted.end(), c) - sorted.begin();
+}
+
+inline void build_compact_strokes(int N, const std::vector<int> &L,
+                                  const std::string &D,
+                                  std::vector<CompactInterval> &vstrokes,
+                                  std::vector<CompactInterval> &hstrokes,
+                                  CoordinateMap &map) {
+  const size_t n = N;
+  long long x = 0, y = 0, x_lo = 0, x_hi = 0, y_lo = 0, y_hi = 0;
+  for (size_t i = 0; i < n; i++) {
+    const DirectionStep step = direction_table.steps[(unsigned char)D[i]];
+    x += step.dx * (long long)L[i];
+    y += step.dy * (long long)L[i];
+    x_lo = std::min(x_lo, x);
+    x_hi = std::max(x_hi, x);
+    y_lo = std::min(y_lo, y);
+    y_hi = std::max(y_hi, y);
+  }
+  map = CoordinateMap();
+
+  if ((unsigned long long)(x_hi - x_lo) > UINT32_MAX ||
+      (unsigned long long)(y_hi - y_lo) > UINT32_MAX) {
+    std::vector<Interval> wide_v, wide_h;
+    build_strokes(N, L, D, wide_v, wide_h);
+    std::vector<long long> xs, ys;
+    for (const Interval &v : wide_v) {
+      xs.push_back(v.a);
+      ys.push_back(v.s);
+      ys.push_back(v.e);
+    }
+    for (const Interval &h : wide_h) {
+      ys.push_back(h.a);
+      xs.push_back(h.s);
+      xs.push_back(h.e);
+    }
+    rank_coordinates(xs, map.xs);
+    rank_coordinates(ys, map.ys);
+    size_t xi = 0, yi = 0;
+    for (size_t i = 0; i < wide_v.size(); i++, yi += 2)
+      vstrokes.push_back({(uint32_t)xs[xi++], (uint32_t)ys[yi],
+                          (uint32_t)ys[yi + 1]});
+    for (size_t i = 0; i < wide_h.size(); i++, xi += 2)
+      hstrokes.push_back({(uint32_t)ys[yi++], (uint32_t)xs[xi],
+                          (uint32_t)xs[xi + 1]});
+    return;
+  }
+
+  map.x_base = x_lo;
+  map.y_base = y_lo;
+  std::vector<Interval> vblock, hblock;
+  x = y = 0;
+  for (size_t begin = 0; begin < n;) {
+    // Blocks end at a run end, so no run is cut in two
+    size_t end = std::min(n, begin + COMPACT_BLOCK);
+    while (end < n && D[end] == D[end - 1])
+      end++;
+    vblock.clear();
+    hblock.clear();
+    build_strokes_range(L.data() + begin, D.data() + begin, end - begin, x, y,
+                        vblock, hblock);
+    for (const Interval &v : vblock)
+      vstrokes.push_back({uint32_t(v.a - x_lo), uint32_t(v.s - y_lo),
+                          uint32_t(v.e - y_lo)});
+    for (const Interval &h : hblock)
+      hstrokes.push_back({uint32_t(h.a - y_lo), uint32_t(h.s - x_lo),
+                          uint32_t(h.e - x_lo)});
+    for (size_t i = begin; i < end; i++) {
+      const DirectionStep step = direction_table.steps[(unsigned char)D[i]];
+      x += step.dx * (long long)L[i];
+      y += step.dy * (long long)L[i];
+    }
+    begin = end;
+  }
+}
+
+inline void sort_compact(std::vector<CompactInterval> &intervals,
+                         std::vector<CompactInterval> &scratch) {
+  radix_sort(
+      intervals, scratch, [](const CompactInterval &i) { return (long long)i.a; },
+      [](const CompactInterval &i) { return (long long)i.s; });
+}
+
+// merge_intervals for compact strokes sorted by (a, s). Lines of length
+// zero are dropped: nothing is strictly inside them, so they never count.
+inline void merge_compact(const std::vector<CompactInterval> &intervals,
+                          std::vector<CompactInterval> &result) {
+  if (intervals.empty())
+    return;
+  CompactInterval current = intervals[0];
+  for (size_t i = 1; i < intervals.size(); i++) {
+    const CompactInterval &next = intervals[i];
+    if (next.a == current.a && next.s <= current.e) {
+      current.e = std::max(current.e, next.e);
+    } else {
+      if (current.s != current.e)
+        result.push_back(current);
+      current = next;
+    }
+  }
+  if (current.s != current.e)
+    result.push_back(current);
+}
+
+struct CompactSweepScratch {
+  std::vector<uint32_t> xs;
+  std::vector<std::pair<uint32_t, uint32_t>> starts, ends, events;
+  Fenwick active;
+};
+
+// count_crossings_sweep on compact lines; events are 8 bytes instead of 16
+inline long long
+count_crossings_compact(const std::vector<CompactInterval> &hlines,
+                        const std::vector<CompactInterval> &vlines,
+                        CompactSweepScratch &sc) {
+  if (hlines.empty() || vlines.empty())
+    return 0;
+
+  std::vector<uint32_t> &xs = sc.xs;
+  xs.clear();
+  for (const CompactInterval &vline : vlines)
+    xs.push_back(vline.a);
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+  std::vector<std::pair<uint32_t, uint32_t>> &starts = sc.starts,
+                                             &ends = sc.ends;
+  starts.clear();
+  ends.clear();
+  uint32_t rank = 0;
+  for (size_t i = 0; i < vlines.size(); i++) {
+    // vlines are sorted by anchor, so ranks only ever step forward
+    if (i > 0 && vlines[i].a != vlines[i - 1].a)
+      rank++;
+    starts.emplace_back(vlines[i].s, rank);
+    ends.emplace_back(vlines[i].e, rank);
+  }
+  auto key = [](const std::pair<uint32_t, uint32_t> &event) {
+    return (long long)event.first;
+  };
+  radix_sort(starts, sc.events, key);
+  radix_sort(ends, sc.events, key);
+
+  Fenwick &active = sc.active;
+  active.reset(xs.size());
+  long long nplus = 0;
+  size_t si = 0, ei = 0;
+  for (const CompactInterval &hline : hlines) {
+    while (si < starts.size() && starts[si].first < hline.a)
+      active.add(starts[si++].second, 1);
+    while (ei < ends.size() && ends[ei].first <= hline.a)
+      active.add(ends[ei++].second, -1);
+
+    size_t lo = std::upper_bound(xs.begin(), xs.end(), hline.s) - xs.begin();
+    size_t hi = std::lower_bound(xs.begin(), xs.end(), hline.e) - xs.begin();
+    if (lo < hi)
+      nplus += active.prefix(hi) - active.prefix(lo);
+  }
+  return nplus;
+}
+
+inline long long
+count_crossings_compact(const std::vector<CompactInterval> &hlines,
+                        const std::vector<CompactInterval> &vlines) {
+  CompactSweepScratch sc;
+  return count_crossings_compact(hlines, vlines, sc);
+}
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "compact_interval.h"
+#include "plus_sign.h"
+#include "plus_stats.h"
+
+using namespace std;
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  PLUS_STATS_BEGIN();
+  vector<CompactInterval> vstrokes, hstrokes, vlines, hlines;
+  CoordinateMap map;
+  build_compact_strokes(N, L, D, vstrokes, hstrokes, map);
+  PLUS_LAP(build);
+  PLUS_STAT_ADD(vstrokes, vstrokes.size());
+  PLUS_STAT_ADD(hstrokes, hstrokes.size());
+
+  vector<CompactInterval> scratch;
+  sort_compact(hstrokes, scratch);
+  PLUS_LAP(sort);
+  merge_compact(hstrokes, hlines);
+  PLUS_LAP(merge);
+  sort_compact(vstrokes, scratch);
+  PLUS_LAP(sort);
+  merge_compact(vstrokes, vlines);
+  PLUS_LAP(merge);
+  PLUS_STAT_ADD(vlines, vlines.size());
+  PLUS_STAT_ADD(hlines, hlines.size());
+
+  long long nplus = count_crossings_compact(hlines, vlines);
+  PLUS_LAP(count);
+  PLUS_STAT_ADD(crossings, nplus);
+  PLUS_STATS_END("compact_ranks");
+  return nplus;
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
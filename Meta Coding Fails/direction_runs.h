@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#ifndef PLUS_SIGN_X86
+#define PLUS_SIGN_X86 1
+#endif
+#endif
+
+// Run boundaries of the direction string: i is the last index of a run when
+// it is the last character or D[i + 1] != D[i]. Kernels look at D[begin, end)
+// of a string of length n and write the run ends found there, minus begin,
+// to out (which must have room for end - begin entries). Returns how many.
+using RunEndKernel = size_t (*)(const char *D, size_t begin, size_t end,
+                                size_t n, uint32_t *out);
+
+// Run ends in D[from, end), written relative to origin
+inline size_t run_ends_from(const char *D, size_t from, size_t end, size_t n,
+                            size_t origin, uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = from; i < end; i++) {
+    out[count] = i - origin;
+    count += i + 1 == n || D[i + 1] != D[i];
+  }
+  return count;
+}
+
+inline size_t run_ends_scalar(const char *D, size_t begin, size_t end,
+                              size_t n, uint32_t *out) {
+  return run_ends_from(D, begin, end, n, begin, out);
+}
+
+#ifdef PLUS_SIGN_X86
+// Compares 32 characters with their successors at once; only the set bits of
+// the difference mask, one per run, are visited
+__attribute__((target("avx2,bmi"))) inline size_t
+run_ends_avx2(const char *D, size_t begin, size_t end, size_t n,
+              uint32_t *out) {
+  size_t count = 0;
+  size_t i = begin;
+  // The shifted load reads D[i + 32], so stop while that still exists
+  for (; i + 32 <= end && i + 32 < n; i += 32) {
+    __m256i cur = _mm256_loadu_si256((const __m256i *)(D + i));
+    __m256i next = _mm256_loadu_si256((const __m256i *)(D + i + 1));
+    uint32_t ends =
+        ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(cur, next));
+    const uint32_t base = i - begin;
+    for (; ends; ends &= ends - 1)
+      out[count++] = base + _tzcnt_u32(ends);
+  }
+  return count + run_ends_from(D, i, end, n, begin, out + count);
+}
+#endif
+
+// Picks the widest kernel the CPU supports, once
+inline RunEndKernel run_end_kernel() {
+  static const RunEndKernel kernel = [] {
+#ifdef PLUS_SIGN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi"))
+      return run_ends_avx2;
+#endif
+    return run_ends_scalar;
+  }();
+  return kernel;
+}
+
+// How a block of directions turns: how many of D[begin, end) end a run, and
+// how many equal the character four on (periods of 1, 2 and 4 repeat
+// there). Profiles are cheap enough to take before deciding how to build a
+// block.
+struct TurnProfile {
+  size_t run_ends = 0, repeats = 0;
+};
+
+using TurnProfileKernel = TurnProfile (*)(const char *D, size_t begin,
+                                          size_t end, size_t n);
+
+inline TurnProfile turn_profile_from(const char *D, size_t i, size_t end,
+                                     size_t n, TurnProfile profile) {
+  for (; i < end; i++) {
+    profile.run_ends += i + 1 == n || D[i + 1] != D[i];
+    profile.repeats += i + 4 < n && D[i + 4] == D[i];
+  }
+  return profile;
+}
+
+inline TurnProfile turn_profile_scalar(const char *D, size_t begin,
+                                       size_t end, size_t n) {
+  return turn_profile_from(D, begin, end, n, TurnProfile());
+}
+
+#ifdef PLUS_SIGN_X86
+__attribute__((target("avx2,popcnt"))) inline TurnProfile
+turn_profile_avx2(const char *D, size_t begin, size_t end, size_t n) {
+  TurnProfile profile;
+  size_t i = begin;
+  for (; i + 32 <= end && i + 36 <= n; i += 32) {
+    __m256i cur = _mm256_loadu_si256((const __m256i *)(D + i));
+    __m256i next = _mm256_loadu_si256((const __m256i *)(D + i + 1));
+    __m256i fourth = _mm256_loadu_si256((const __m256i *)(D + i + 4));
+    profile.run_ends += 32 - _mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(
+                                 _mm256_cmpeq_epi8(cur, next)));
+    profile.repeats += _mm_popcnt_u32(
+        (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(cur, fourth)));
+  }
+  return turn_profile_from(D, i, end, n, profile);
+}
+#endif
+
+inline TurnProfileKernel turn_profile_kernel() {
+  static const TurnProfileKernel kernel = [] {
+#ifdef PLUS_SIGN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+      return turn_profile_avx2;
+#endif
+    return turn_profile_scalar;
+  }();
+  return kernel;
+}
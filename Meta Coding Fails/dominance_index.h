@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Dynamic weighted points (anchor, coord) answering
+//   sum of weights with lo <= anchor <= hi and coord <= at
+// in O(log^2 N), with O(log^2 N) amortized inserts.
+//
+// Removal is an insert with the opposite weight, so the structure only ever
+// grows by inserts and can use the logarithmic method: a small unsorted
+// buffer plus static levels of doubling size, each a wavelet matrix over the
+// points sorted by anchor. Rebuilding a level merges equal points and drops
+// the ones whose weights cancel.
+
+// Bit vector with O(1) rank
+struct RankBits {
+  std::vector<uint64_t> words;
+  std::vector<uint32_t> before; // ones in words[0, i)
+
+  void build(const std::vector<bool> &bits) {
+    words.assign(bits.size() / 64 + 1, 0);
+    for (size_t i = 0; i < bits.size(); i++) {
+      if (bits[i])
+        words[i / 64] |= 1ULL << (i % 64);
+    }
+    before.assign(words.size() + 1, 0);
+    for (size_t w = 0; w < words.size(); w++)
+      before[w + 1] = before[w] + __builtin_popcountll(words[w]);
+  }
+
+  // Ones in [0, i)
+  size_t rank1(size_t i) const {
+    uint64_t partial = words[i / 64] & ((1ULL << (i % 64)) - 1);
+    return before[i / 64] + __builtin_popcountll(partial);
+  }
+};
+
+// Counts positions in [l, r) whose value is below v
+struct WaveletMatrix {
+  int bits = 0;
+  std::vector<RankBits> levels;
+  std::vector<size_t> zeros;
+
+  void build(std::vector<uint32_t> values, uint32_t alphabet) {
+    bits = 1;
+    while (bits < 32 && (alphabet >> bits) != 0)
+      bits++;
+    levels.assign(bits, RankBits());
+    zeros.assign(bits, 0);
+
+    std::vector<bool> flags(values.size());
+    std::vector<uint32_t> next(values.size());
+    for (int b = bits - 1; b >= 0; b--) {
+      size_t nz = 0;
+      for (size_t i = 0; i < values.size(); i++) {
+        flags[i] = (values[i] >> b) & 1;
+        nz += !flags[i];
+      }
+      levels[b].build(flags);
+      zeros[b] = nz;
+      // Stable partition: zeros then ones
+      size_t zi = 0, oi = nz;
+      for (size_t i = 0; i < values.size(); i++)
+        next[flags[i] ? oi++ : zi++] = values[i];
+      values.swap(next);
+    }
+  }
+
+  size_t count_less(size_t l, size_t r, uint32_t v) const {
+    if (v >> bits)
+      return r - l;
+    size_t less = 0;
+    for (int b = bits - 1; b >= 0 && l < r; b--) {
+      const RankBits &level = levels[b];
+      size_t l1 = level.rank1(l), r1 = level.rank1(r);
+      if ((v >> b) & 1) {
+        less += (r - l) - (r1 - l1);
+        l = zeros[b] + l1;
+        r = zeros[b] + r1;
+      } else {
+        l -= l1;
+        r -= r1;
+      }
+    }
+    return less;
+  }
+};
+
+struct WeightedPoint {
+  long long anchor, coord;
+  long long weight;
+};
+
+// One static level. Points of weight w are stored |w| times in the positive
+// or negative matrix, which after cancellation is almost always once.
+class DominanceLevel {
+public:
+  std::vector<WeightedPoint> points; // merged, sorted by (anchor, coord)
+
+  void build(std::vector<WeightedPoint> &raw) {
+    std::sort(raw.begin(), raw.end(),
+              [](const WeightedPoint &l, const WeightedPoint &r) {
+                if (l.anchor != r.anchor)
+                  return l.anchor < r.anchor;
+                return l.coord < r.coord;
+              });
+    points.clear();
+    for (const WeightedPoint &p : raw) {
+      if (!points.empty() && points.back().anchor == p.anchor &&
+          points.back().coord == p.coord)
+        points.back().weight += p.weight;
+      else
+        points.push_back(p);
+      if (points.back().weight == 0)
+        points.pop_back();
+    }
+
+    coords.clear();
+    for (const WeightedPoint &p : points)
+      coords.push_back(p.coord);
+    std::sort(coords.begin(), coords.end());
+    coords.erase(std::unique(coords.begin(), coords.end()), coords.end());
+
+    build_side(pos, pos_anchors, 1);
+    build_side(neg, neg_anchors, -1);
+  }
+
+  long long sum(long long lo, long long hi, long long at) const {
+    uint32_t v = std::upper_bound(coords.begin(), coords.end(), at) -
+                 coords.begin();
+    return side_count(pos, pos_anchors, lo, hi, v) -
+           side_count(neg, neg_anchors, lo, hi, v);
+  }
+
+  bool empty() const { return points.empty(); }
+
+  void clear() {
+    points.clear();
+    coords.clear();
+    pos_anchors.clear();
+    neg_anchors.clear();
+    pos = WaveletMatrix();
+    neg = WaveletMatrix();
+  }
+
+private:
+  std::vector<long long> coords; // distinct, sorted; values are ranks
+  std::vector<long long> pos_anchors, neg_anchors;
+  WaveletMatrix pos, neg;
+
+  void build_side(WaveletMatrix &matrix, std::vector<long long> &anchors,
+                  int sign) {
+    std::vector<uint32_t> values;
+    anchors.clear();
+    for (const WeightedPoint &p : points) {
+      long long copies = p.weight * sign;
+      uint32_t rank =
+          std::lower_bound(coords.begin(), coords.end(), p.coord) -
+          coords.begin();
+      for (long long c = 0; c < copies; c++) {
+        anchors.push_back(p.anchor);
+        values.push_back(rank);
+      }
+    }
+    matrix.build(values, coords.size());
+  }
+
+  static long long side_count(const WaveletMatrix &matrix,
+                              const std::vector<long long> &anchors,
+                              long long lo, long long hi, uint32_t v) {
+    size_t l = std::lower_bound(anchors.begin(), anchors.end(), lo) -
+               anchors.begin();
+    size_t r = std::upper_bound(anchors.begin(), anchors.end(), hi) -
+               anchors.begin();
+    return l < r ? matrix.count_less(l, r, v) : 0;
+  }
+};
+
+class DominanceIndex {
+public:
+  void add(long long anchor, long long coord, long long weight) {
+    buffer.push_back({anchor, coord, weight});
+    if (buffer.size() < buffer_cap)
+      return;
+
+    // Binary counter: carry the buffer up into the first empty level
+    std::vector<WeightedPoint> carry;
+    carry.swap(buffer);
+    size_t k = 0;
+    for (; k < levels.size() && !levels[k].empty(); k++) {
+      carry.insert(carry.end(), levels[k].points.begin(),
+                   levels[k].points.end());
+      levels[k].clear();
+    }
+    if (k == levels.size())
+      levels.emplace_back();
+    levels[k].build(carry);
+  }
+
+  long long sum(long long lo, long long hi, long long at) const {
+    long long total = 0;
+    for (const WeightedPoint &p : buffer) {
+      if (lo <= p.anchor && p.anchor <= hi && p.coord <= at)
+        total += p.weight;
+    }
+    for (const DominanceLevel &level : levels) {
+      if (!level.empty())
+        total += level.sum(lo, hi, at);
+    }
+    return total;
+  }
+
+private:
+  static constexpr size_t buffer_cap = 64;
+  std::vector<WeightedPoint> buffer;
+  std::vector<DominanceLevel> levels;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "mapped_file.h"
+
+// Binary drawing format, little-endian:
+//
+//   header       BinaryDrawingHeader, 40 bytes
+//   chunk table  chunks x uint64: where each chunk's lengths start, as a
+//                byte offset into the lengths section
+//   directions   (steps + 3) / 4 bytes, 2 bits per step from the low bits
+//                up: U = 0, D = 1, L = 2, R = 3
+//   lengths      one LEB128 varint per step, at most INT_MAX like L
+//
+// Chunk c covers steps [c * chunk_steps, (c + 1) * chunk_steps), so a chunk
+// can be decoded without the ones before it. chunk_steps = 0 means no table
+// and a single chunk.
+
+struct BinaryDrawingHeader {
+  char magic[8];        // "PLUSDRW1"
+  uint32_t version;     // 1
+  uint32_t chunk_steps;
+  uint64_t steps;
+  uint64_t chunks;
+  uint64_t lengths_bytes;
+};
+static_assert(sizeof(BinaryDrawingHeader) == 40, "header layout");
+
+constexpr char BINARY_DRAWING_MAGIC[8] = {'P', 'L', 'U', 'S',
+                                          'D', 'R', 'W', '1'};
+constexpr uint32_t BINARY_DRAWING_CHUNK = 1 << 16;
+
+constexpr char binary_direction_char[4] = {'U', 'D', 'L', 'R'};
+
+inline int binary_direction_code(char d) {
+  switch (d) {
+  case 'U':
+    return 0;
+  case 'D':
+    return 1;
+  case 'L':
+    return 2;
+  case 'R':
+    return 3;
+  }
+  return -1;
+}
+
+// False if the drawing has a direction other than UDLR or a negative length,
+// which the format can't hold
+inline bool write_binary_drawing(std::ostream &out, const Drawing &d,
+                                 uint32_t chunk_steps = BINARY_DRAWING_CHUNK) {
+  const uint64_t steps = d.N;
+  std::vector<uint8_t> directions((steps + 3) / 4, 0), lengths;
+  std::vector<uint64_t> table;
+  for (uint64_t i = 0; i < steps; i++) {
+    const int code = binary_direction_code(d.D[i]);
+    if (code < 0 || d.L[i] < 0)
+      return false;
+    directions[i / 4] |= code << (2 * (i % 4));
+    if (chunk_steps && i % chunk_steps == 0)
+      table.push_back(lengths.size());
+    for (uint32_t len = d.L[i];; len >>= 7) {
+      if (len < 0x80) {
+        lengths.push_back(len);
+        break;
+      }
+      lengths.push_back((len & 0x7f) | 0x80);
+    }
+  }
+
+  BinaryDrawingHeader header;
+  std::memcpy(header.magic, BINARY_DRAWING_MAGIC, 8);
+  header.version = 1;
+  header.chunk_steps = chunk_steps;
+  header.steps = steps;
+  header.chunks = table.size();
+  header.lengths_bytes = lengths.size();
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(table.data()),
+            table.size() * sizeof(uint64_t));
+  out.write(reinterpret_cast<const char *>(directions.data()),
+            directions.size());
+  out.write(reinterpret_cast<const char *>(lengths.data()), lengths.size());
+  return bool(out);
+}
+
+// A binary drawing read in place from a mapping. Nothing is copied; steps
+// are decoded as they are visited.
+class BinaryDrawingView {
+public:
+  // False if the file can't be mapped or isn't a well formed drawing
+  bool open(const char *path) {
+    if (!file.open(path) || file.size < sizeof(BinaryDrawingHeader))
+      return false;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, BINARY_DRAWING_MAGIC, 8) != 0 ||
+        header.version != 1)
+      return false;
+    if (header.chunk_steps == 0 ? header.chunks != 0
+                                : header.chunks != (header.steps +
+                                                    header.chunk_steps - 1) /
+                                                       header.chunk_steps)
+      return false;
+
+    const uint64_t table_bytes = header.chunks * sizeof(uint64_t);
+    const uint64_t direction_bytes = (header.steps + 3) / 4;
+    const uint64_t need = sizeof(header) + table_bytes + direction_bytes +
+                          header.lengths_bytes;
+    if (header.chunks > file.size || header.steps > 4 * uint64_t(file.size) ||
+        header.lengths_bytes > file.size || need != file.size)
+      return false;
+    table = reinterpret_cast<const uint64_t *>(file.data + sizeof(header));
+    directions =
+        reinterpret_cast<const uint8_t *>(file.data + sizeof(header)) +
+        table_bytes;
+    lengths = directions + direction_bytes;
+    for (uint64_t c = 0; c < header.chunks; c++) {
+      if (table[c] >= header.lengths_bytes && header.steps > 0)
+        return false;
+    }
+    return true;
+  }
+
+  uint64_t steps() const { return header.steps; }
+  uint64_t chunks() const { return header.chunks ? header.chunks : 1; }
+
+  uint64_t chunk_begin(uint64_t c) const {
+    return header.chunk_steps ? c * header.chunk_steps : 0;
+  }
+  uint64_t chunk_end(uint64_t c) const {
+    return c + 1 < chunks() ? chunk_begin(c + 1) : header.steps;
+  }
+
+  char direction(uint64_t i) const {
+    return binary_direction_char[(directions[i / 4] >> (2 * (i % 4))) & 3];
+  }
+
+  // Calls step(direction, length) for every step of chunks [first, last).
+  // False if a length runs off the end of the file or doesn't fit an int.
+  template <class Step>
+  bool decode(uint64_t first, uint64_t last, Step step) const {
+    if (first >= last)
+      return true;
+    const uint8_t *p = lengths + (header.chunks ? table[first] : 0);
+    const uint8_t *end = lengths + header.lengths_bytes;
+    for (uint64_t i = chunk_begin(first), stop = chunk_end(last - 1);
+         i < stop; i++) {
+      uint64_t len = 0;
+      for (int shift = 0;; shift += 7) {
+        if (p == end || shift > 28)
+          return false;
+        const uint8_t byte = *p++;
+        len |= uint64_t(byte & 0x7f) << shift;
+        if (byte < 0x80)
+          break;
+      }
+      if (len > INT_MAX)
+        return false;
+      step(direction(i), (long long)len);
+    }
+    return true;
+  }
+
+  // Drops the resident pages of chunks [first, last) once they are decoded
+  void release(uint64_t first, uint64_t last) const {
+    if (first >= last || !header.chunks)
+      return;
+    const uint8_t *to = last < header.chunks
+                            ? lengths + table[last]
+                            : lengths + header.lengths_bytes;
+    file.release(reinterpret_cast<const char *>(lengths + table[first]),
+                 reinterpret_cast<const char *>(to));
+  }
+
+private:
+  MappedFile file;
+  BinaryDrawingHeader header{};
+  const uint64_t *table = nullptr;
+  const uint8_t *directions = nullptr, *lengths = nullptr;
+};
@@ -0,0 +1,61 @@
+// Converts a drawing between the text format of drawing_gen.h and the binary
+// format of drawing_bin.h.
+//
+//   g++ -std=c++17 -O2 -I. -o drawing_convert drawing_convert.cpp
+//   ./drawing_convert in.txt out.bin [steps per chunk, 0 for no table]
+//   ./drawing_convert --to-text in.bin out.txt
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "drawing_bin.h"
+#include "drawing_gen.h"
+
+using namespace std;
+
+int main(int argc, char **argv) {
+  if (argc > 1 && string(argv[1]) == "--to-text") {
+    if (argc != 4) {
+      cerr << "usage: " << argv[0] << " --to-text in.bin out.txt\n";
+      return 1;
+    }
+    BinaryDrawingView view;
+    if (!view.open(argv[2])) {
+      cerr << argv[2] << ": not a binary drawing\n";
+      return 1;
+    }
+    Drawing d;
+    if (!view.decode(0, view.chunks(),
+                     [&](char dir, long long len) { d.push(dir, len); })) {
+      cerr << argv[2] << ": truncated lengths\n";
+      return 1;
+    }
+    ofstream out(argv[3]);
+    write_drawing(out, d);
+    return out ? 0 : 1;
+  }
+
+  if (argc < 3 || argc > 4) {
+    cerr << "usage: " << argv[0]
+         << " in.txt out.bin [steps per chunk, 0 for no table]\n"
+         << "       " << argv[0] << " --to-text in.bin out.txt\n";
+    return 1;
+  }
+  uint32_t chunk_steps =
+      argc > 3 ? strtoul(argv[3], nullptr, 10) : BINARY_DRAWING_CHUNK;
+
+  ifstream in(argv[1]);
+  Drawing d;
+  if (!read_drawing(in, d)) {
+    cerr << argv[1] << ": not a text drawing\n";
+    return 1;
+  }
+  ofstream out(argv[2], ios::binary);
+  if (!write_binary_drawing(out, d, chunk_steps)) {
+    cerr << argv[1] << ": directions must be UDLR and lengths non-negative\n";
+    return 1;
+  }
+  return 0;
+}
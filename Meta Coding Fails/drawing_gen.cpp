@@ -0,0 +1,37 @@
+// Writes a generated drawing in the text format from drawing_gen.h.
+//
+//   g++ -std=c++17 -O2 -I. -o drawing_gen drawing_gen.cpp
+//   ./drawing_gen <shape> <n> [seed] > drawing.txt
+//
+// Shapes: random_walk, comb, retrace, spiral, staircase.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "drawing_gen.h"
+
+using namespace std;
+
+int main(int argc, char **argv) {
+  Shape shape;
+  if (argc < 3 || !parse_shape(argv[1], shape)) {
+    cerr << "usage: " << argv[0] << " <shape> <n> [seed]\n";
+    cerr << "shapes:";
+    for (Shape s : all_shapes)
+      cerr << " " << shape_name(s);
+    cerr << "\n";
+    return 1;
+  }
+  long long n = atoll(argv[2]);
+  if (n < 0 || n > 2000000000) {
+    cerr << "n must be in [0, 2e9]\n";
+    return 1;
+  }
+  uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+
+  ios::sync_with_stdio(false);
+  Drawing d = generate_drawing(shape, (int)n, seed);
+  write_drawing(cout, d);
+  return 0;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Seeded drawing generator for stress tests and benchmarks. The same
+// (shape, n, seed) always gives the same drawing, on any platform, since it
+// only uses splitmix64 and integer arithmetic.
+//
+// Text format, as read and written below:
+//   N
+//   L1 L2 ... LN
+//   D
+
+struct Drawing {
+  int N = 0;
+  std::vector<int> L;
+  std::string D;
+
+  void push(char dir, int len) {
+    D.push_back(dir);
+    L.push_back(len);
+    N++;
+  }
+};
+
+enum class Shape {
+  random_walk, // short random strokes, few crossings
+  comb,        // n/2 stacked rows then n/2 columns through all of them
+  retrace,     // long collinear back-and-forth runs, stresses merging
+  spiral,      // square spiral, n strokes and no crossings
+  staircase,   // alternating U/R, every stroke survives run-collapsing
+};
+
+static const Shape all_shapes[] = {Shape::random_walk, Shape::comb,
+                                   Shape::retrace, Shape::spiral,
+                                   Shape::staircase};
+
+inline const char *shape_name(Shape shape) {
+  switch (shape) {
+  case Shape::random_walk:
+    return "random_walk";
+  case Shape::comb:
+    return "comb";
+  case Shape::retrace:
+    return "retrace";
+  case Shape::spiral:
+    return "spiral";
+  case Shape::staircase:
+    return "staircase";
+  }
+  return "?";
+}
+
+inline bool parse_shape(const std::string &name, Shape &shape) {
+  for (Shape s : all_shapes) {
+    if (name == shape_name(s)) {
+      shape = s;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct SplitMix64 {
+  uint64_t state;
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [lo, hi]
+  int range(int lo, int hi) { return lo + next() % (uint64_t)(hi - lo + 1); }
+};
+
+inline void gen_random_walk(Drawing &d, int n, SplitMix64 &rng) {
+  for (int i = 0; i < n; i++)
+    d.push("UDLR"[rng.next() & 3], rng.range(1, 10));
+}
+
+// Rows and columns have jittered ends so they don't all line up, but every
+// row still spans every column, giving about (n/4)^2 crossings.
+inline void gen_comb(Drawing &d, int n, SplitMix64 &rng) {
+  int half = n / 2;
+  int rows = half / 2 + 1, cols = (n - half) / 2 + 1;
+  long long x = 0, y = 0;
+  // Rows at y = 0, 1, 2, ... spanning x = 0 .. cols + jitter
+  while (d.N < half) {
+    if (x == 0) {
+      int len = cols + rng.range(1, 4);
+      d.push('R', len);
+      x += len;
+    } else {
+      d.push('L', x);
+      x = 0;
+    }
+    if (d.N < half) {
+      d.push('U', 1);
+      y++;
+    }
+  }
+  if (x != 0 && d.N < n)
+    d.push('L', x);
+  // Columns at x = 1, 2, 3, ... reaching below row 0 and above the top row
+  while (d.N < n) {
+    d.push('R', 1);
+    if (d.N >= n)
+      break;
+    if (y >= 0) {
+      long long to = -rng.range(1, 4);
+      d.push('D', y - to);
+      y = to;
+    } else {
+      long long to = rows + rng.range(1, 4);
+      d.push('U', to - y);
+      y = to;
+    }
+  }
+}
+
+// Blocks of strokes that go back and forth along one line, alternating
+// between a vertical and a horizontal block so the merged lines cross.
+inline void gen_retrace(Drawing &d, int n, SplitMix64 &rng) {
+  bool vertical = true;
+  while (d.N < n) {
+    int block = rng.range(4, 64);
+    for (int i = 0; i < block && d.N < n; i++) {
+      char dir = vertical ? "UD"[i & 1] : "LR"[i & 1];
+      d.push(dir, rng.range(1, 1000));
+    }
+    vertical = !vertical;
+  }
+}
+
+inline void gen_spiral(Drawing &d, int n, SplitMix64 &rng) {
+  // Arms grow by 1 or 2 so the spiral never touches its previous turn
+  int len = 1;
+  for (int i = 0; i < n; i++) {
+    d.push("RULD"[i % 4], len);
+    if (i % 2)
+      len += rng.range(1, 2);
+  }
+}
+
+inline void gen_staircase(Drawing &d, int n, SplitMix64 &rng) {
+  for (int i = 0; i < n; i++)
+    d.push("UR"[i & 1], rng.range(1, 10));
+}
+
+inline Drawing generate_drawing(Shape shape, int n, uint64_t seed) {
+  Drawing d;
+  d.L.reserve(n);
+  d.D.reserve(n);
+  SplitMix64 rng{seed};
+  switch (shape) {
+  case Shape::random_walk:
+    gen_random_walk(d, n, rng);
+    break;
+  case Shape::comb:
+    gen_comb(d, n, rng);
+    break;
+  case Shape::retrace:
+    gen_retrace(d, n, rng);
+    break;
+  case Shape::spiral:
+    gen_spiral(d, n, rng);
+    break;
+  case Shape::staircase:
+    gen_staircase(d, n, rng);
+    break;
+  }
+  return d;
+}
+
+inline void write_drawing(std::ostream &out, const Drawing &d) {
+  out << d.N << "\n";
+  for (int i = 0; i < d.N; i++)
+    out << d.L[i] << (i + 1 < d.N ? ' ' : '\n');
+  out << d.D << "\n";
+}
+
+inline bool read_drawing(std::istream &in, Drawing &d) {
+  if (!(in >> d.N) || d.N < 0)
+    return false;
+  d.L.resize(d.N);
+  for (int i = 0; i < d.N; i++) {
+    if (!(in >> d.L[i]))
+      return false;
+  }
+  if (d.N == 0) {
+    d.D.clear();
+    return true;
+  }
+  return (in >> d.D) && (int)d.D.size() == d.N;
+}
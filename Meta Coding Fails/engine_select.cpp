@@ -0,0 +1,145 @@
+// Counts drawings through the engine registry (engines.h) and shows what the
+// selector saw and which engine it picked.
+//
+//   g++ -std=c++17 -O2 -pthread -I. -o engine_select engine_select.cpp
+//   ./engine_select --list
+//   ./engine_select [--engine name] drawings.txt [more.txt ...]
+//
+// Files hold drawings in the text format of drawing_gen.h. --engine (or
+// PLUS_ENGINE) pins one engine instead of selecting. With no files it runs
+// the usual three cases, then times the picked engine against the reference
+// on each generated shape and on a comb with one long step.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "engines.h"
+#include "plus_engine.h"
+
+using namespace std;
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  return getPlusSignCountAuto(N, move(L), move(D));
+}
+
+static void print_features(const DrawingFeatures &f) {
+  printf("n %lld, turns %lld, sample %lld/%lld, est. crossings/n %.2f, "
+         "est. candidates/n %.2f, scan bound/n %.2f",
+         f.n, f.turns, f.hsample, f.vsample, f.density(),
+         f.n > 0 ? f.candidates / f.n : 0, f.n > 0 ? f.scan_bound / f.n : 0);
+}
+
+static double time_ms(const PlusEngine &engine, const Drawing &d,
+                      long long &result) {
+  auto start = chrono::steady_clock::now();
+  result = engine.count(d.N, d.L, d.D);
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  EngineRegistry &registry = engine_registry();
+  vector<string> files;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--list") {
+      for (const PlusEngine &engine : registry.engines())
+        cout << engine.name << (engine.exact ? "" : " (not exact)") << "\n";
+      return 0;
+    }
+    if (arg == "--engine" && i + 1 < argc) {
+      if (!registry.force(argv[++i])) {
+        cerr << argv[i] << " is not an engine; see --list\n";
+        return 1;
+      }
+      continue;
+    }
+    files.push_back(arg);
+  }
+
+  if (!files.empty()) {
+    int status = 0;
+    for (const string &file : files) {
+      ifstream in(file);
+      Drawing d;
+      for (int k = 0; read_drawing(in, d); k++) {
+        DrawingFeatures f = measure_features(d.N, d.L, d.D);
+        const PlusEngine *engine = registry.select(f);
+        long long result = 0;
+        double ms = time_ms(*engine, d, result);
+        printf("%s #%d: %lld by %s in %.2f ms; ", file.c_str(), k, result,
+               engine->name, ms);
+        print_features(f);
+        printf("\n");
+      }
+      if (!in.eof()) {
+        cerr << file << ": stopped at something that isn't a drawing\n";
+        status = 1;
+      }
+    }
+    return status;
+  }
+
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  const PlusEngine &reference = registry.engines()[0];
+  bool same = true;
+  for (int n : {10000, 1000000}) {
+    for (Shape shape : all_shapes) {
+      Drawing d = generate_drawing(shape, n, 1);
+      DrawingFeatures f = measure_features(d.N, d.L, d.D);
+      const PlusEngine *engine = registry.select(f);
+      long long picked = 0, expected_count = 0;
+      double picked_ms = time_ms(*engine, d, picked);
+      double reference_ms = time_ms(reference, d, expected_count);
+      printf("%-11s %8d: %-14s %8.2f ms, %s %8.2f ms\n", shape_name(shape), n,
+             engine->name, picked_ms, reference.name, reference_ms);
+      same = same && picked == expected_count;
+    }
+  }
+  // One long step stretches the drawing without thinning it out; a comb
+  // must still stay away from the y-window scans
+  Drawing d = generate_drawing(Shape::comb, 10000, 1);
+  d.push('U', 1000000000);
+  d.push('R', 1000000000);
+  const PlusEngine *engine = registry.select(measure_features(d.N, d.L, d.D));
+  long long picked = 0, expected_count = 0;
+  double picked_ms = time_ms(*engine, d, picked);
+  double reference_ms = time_ms(reference, d, expected_count);
+  printf("%-11s %8d: %-14s %8.2f ms, %s %8.2f ms\n", "comb+step", d.N,
+         engine->name, picked_ms, reference.name, reference_ms);
+  same = same && picked == expected_count;
+  const string scan = engine->name;
+  if (scan == "vector" || scan == "soa_avx2") {
+    cout << "A long step sent a comb to a y-window scan\n";
+    same = false;
+  }
+
+  cout << "Picked engines " << (same ? "match" : "differ from")
+       << " the reference\n";
+  return !same;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+// Every getPlusSignCount variant in this directory behind one registry
+// (plus_engine.h), and getPlusSignCountAuto, which picks one per call.
+//
+// Each variant is a standalone file with its own main(), so each one is
+// included into its own namespace with main renamed. All headers those files
+// use must be included here first so their include guards keep them global.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "arena.h"
+#include "arena_resource.h"
+#include "cdq_count.h"
+#include "compact_interval.h"
+#include "dominance_index.h"
+#include "drawing_gen.h"
+#include "external_sweep.h"
+#include "flat_hash.h"
+#include "interval_soa.h"
+#include "parallel_merge.h"
+#include "parallel_strokes.h"
+#include "plus_engine.h"
+#include "plus_sign.h"
+#include "plus_stats.h"
+#include "work_stealing_pool.h"
+
+#define main main_unused
+namespace vector_slow {
+#include "vector(slow).cpp"
+}
+namespace multisets_slow {
+#include "multisets(slow).cpp"
+}
+namespace sets_incorrect {
+#include "sets(incorrect).cpp"
+}
+// The same two with a heap allocation per tree node, to show what the arena
+// saves
+#define PLUS_HEAP_NODES
+namespace multisets_heap {
+#include "multisets(slow).cpp"
+}
+namespace sets_heap {
+#include "sets(incorrect).cpp"
+}
+#undef PLUS_HEAP_NODES
+namespace half_merge_incorrect {
+#include "half_merge(incorrect).cpp"
+}
+namespace linked_list_slow {
+#include "linked_list(slow).cpp"
+}
+namespace linked_list_slow_copy {
+#include "linked_list(slow) copy.cpp"
+}
+namespace simple_idea {
+#include "simple_idea(unfinished  memory exceeded).cpp"
+}
+namespace unit_edges {
+#include "unit_edges.cpp"
+}
+namespace sweep_fenwick {
+#include "sweep_fenwick.cpp"
+}
+namespace parallel_bands {
+#include "parallel_bands.cpp"
+}
+namespace cdq_parallel {
+#include "cdq_parallel.cpp"
+}
+namespace soa_avx2 {
+#include "soa_avx2.cpp"
+}
+namespace online_append {
+#include "online_append.cpp"
+}
+namespace compact_ranks {
+#include "compact_ranks.cpp"
+}
+namespace external_count {
+#include "external_count.cpp"
+}
+#undef main
+
+// The first engine is the reference the benchmark checks the others
+// against. exact is whether an engine matched a brute-force unit-edge count
+// on thousands of small random drawings, zero-length steps included, not
+// just the benchmark's shapes. The misses are the "incorrect" files,
+// linked_list(slow).cpp, and simple_idea, which still returns 0.
+inline EngineRegistry &engine_registry() {
+  static EngineRegistry registry = [] {
+    EngineRegistry r;
+    r.add({"sweep_fenwick", sweep_fenwick::getPlusSignCount, true});
+    r.add({"parallel_bands", parallel_bands::getPlusSignCount, true});
+    r.add({"cdq_parallel", cdq_parallel::getPlusSignCount, true});
+    r.add({"soa_avx2", soa_avx2::getPlusSignCount, true});
+    r.add({"compact_ranks", compact_ranks::getPlusSignCount, true});
+    r.add({"online_append", online_append::getPlusSignCount, true});
+    r.add({"external", external_count::getPlusSignCount, true});
+    r.add({"vector", vector_slow::getPlusSignCount, true});
+    r.add({"multisets", multisets_slow::getPlusSignCount, true});
+    r.add({"multisets_heap", multisets_heap::getPlusSignCount, true});
+    r.add({"sets", sets_incorrect::getPlusSignCount, false});
+    r.add({"sets_heap", sets_heap::getPlusSignCount, false});
+    r.add({"half_merge", half_merge_incorrect::getPlusSignCount, false});
+    r.add({"linked_list", linked_list_slow::getPlusSignCount, false});
+    r.add({"linked_list_copy", linked_list_slow_copy::getPlusSignCount,
+           true});
+    r.add({"simple_idea", simple_idea::getPlusSignCount, false});
+    r.add({"unit_edges", unit_edges::getPlusSignCount, true});
+    if (const char *name = std::getenv("PLUS_ENGINE")) {
+      if (!r.force(name))
+        std::cerr << "PLUS_ENGINE=" << name << " is not an engine\n";
+    }
+    return r;
+  }();
+  return registry;
+}
+
+inline long long getPlusSignCountAuto(int N, std::vector<int> L,
+                                      std::string D) {
+  return engine_registry().count(N, std::move(L), std::move(D));
+}
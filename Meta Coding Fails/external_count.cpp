@@ -0,0 +1,121 @@
+// Counts plus signs with ExternalCounter (external_sweep.h), which keeps
+// strokes in temp files and holds only a memory budget's worth of them.
+//
+//   g++ -std=c++17 -O2 -I. -o external_count external_count.cpp
+//   ./external_count [strokes] [budget in MB] [temp dir]
+//
+// Runs the usual three cases and one with a zero-length line, checks that a
+// comb under a 1 MB budget keeps its active set within a quarter of it, then
+// counts a generated drawing within the budget and checks it against the
+// in-memory sweep.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "external_sweep.h"
+#include "plus_sign.h"
+
+using namespace std;
+
+static long long count_in_memory(const Drawing &d) {
+  vector<Interval> vstrokes, hstrokes, vlines, hlines, scratch;
+  build_strokes(d.N, d.L, d.D, vstrokes, hstrokes);
+  sort_by_anchor_start(hstrokes, scratch);
+  merge_intervals(hstrokes, hlines);
+  sort_by_anchor_start(vstrokes, scratch);
+  merge_intervals(vstrokes, vlines);
+  return count_crossings_sweep(hlines, vlines);
+}
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  ExternalConfig config;
+  config.memory_budget = 64 << 20;
+  ExternalCounter counter(config);
+  for (int i = 0; i < N; i++)
+    counter.step(D[i], L[i]);
+  return counter.finish();
+}
+
+int main(int argc, char **argv) {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // A zero-length vertical line on a horizontal one
+  N = 4;
+  L = {2, 1, 1, 0};
+  D = "RDLD";
+  expected = 0;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // Every column of a comb crosses every row, so all of them are active at
+  // once; the sweep has to go slab by slab to stay in the budget
+  {
+    Drawing comb = generate_drawing(Shape::comb, 200000, 1);
+    ExternalConfig small;
+    small.memory_budget = 1 << 20;
+    ExternalCounter counter(small);
+    for (int i = 0; i < comb.N; i++)
+      counter.step(comb.D[i], comb.L[i]);
+    expected = count_in_memory(comb);
+    result = counter.finish();
+    cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+    const ExternalStats &stats = counter.stats();
+    const bool within = stats.peak_active * EXTERNAL_ACTIVE_NODE_BYTES <=
+                        small.memory_budget / 4;
+    cout << "Comb: at most " << stats.peak_active << " active lines in "
+         << stats.slabs << " slabs, "
+         << (within ? "within" : "over") << " the budget\n\n\n";
+    if (!within || result != expected)
+      return 1;
+  }
+
+  int strokes = argc > 1 ? atoi(argv[1]) : 5000000;
+  ExternalConfig config;
+  config.memory_budget = (argc > 2 ? strtoull(argv[2], nullptr, 10) : 16)
+                         << 20;
+  if (argc > 3)
+    config.temp_dir = argv[3];
+
+  Drawing d = generate_drawing(Shape::random_walk, strokes, 1);
+  auto start = chrono::steady_clock::now();
+  ExternalCounter counter(config);
+  for (int i = 0; i < d.N; i++)
+    counter.step(d.D[i], d.L[i]);
+  long long nplus = counter.finish();
+  double ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+  const ExternalStats &stats = counter.stats();
+  cout << "External: " << nplus << " plus signs in " << ms << " ms, "
+       << stats.runs << " runs (" << stats.merge_passes << " merge passes), "
+       << stats.bytes_spilled / (1 << 20) << " MB spilled, at most "
+       << stats.peak_active << " active lines in " << stats.slabs
+       << " slabs\n";
+
+  long long in_memory = count_in_memory(d);
+  cout << "In memory: " << in_memory << "\n";
+  return nplus != in_memory;
+}
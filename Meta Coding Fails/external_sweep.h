@@ -0,0 +1,524 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+#include <unistd.h>
+
+#include "plus_sign.h"
+#include "radix_sort.h"
+
+// Out-of-core plus sign counting for drawings whose strokes don't fit in
+// memory. Steps go in one at a time; memory stays within a budget and the
+// rest lives in temp files that are only ever read and written front to
+// back.
+//
+//   1. Strokes collect in a buffer per orientation. A full buffer is sorted,
+//      merged into lines and written out as a run.
+//   2. The vertical runs are k-way merged. Merging continues across runs,
+//      and the resulting lines become (s, x) and (e, x) events, spilled as
+//      sorted runs too.
+//   3. The sweep k-way merges the horizontal runs (into lines, in (y, s)
+//      order) and both event streams at once. In memory it keeps only the x
+//      of the vertical lines crossing the current y, in an order statistics
+//      tree.
+//
+// The tree is charged to the budget too. Merged lines on one x never
+// overlap, so no more lines are active at once than there are distinct x.
+// When the vertical lines have more distinct x than a quarter of the budget
+// holds tree nodes, step 2 cuts the x axis into slabs of that many, and
+// step 3 sweeps once per slab, reading all three streams again each time
+// and keeping only the lines of its slab.
+//
+// When there are too many runs for every one to get a reasonable read
+// buffer, groups of them are merged into longer runs first. Each sorter
+// appends its runs to a single temp file, so a drawing of any size needs a
+// handful of file descriptors.
+//
+// Errors opening or writing temp files throw std::runtime_error.
+
+struct ExternalConfig {
+  size_t memory_budget = size_t(256) << 20; // bytes, over all buffers
+  std::string temp_dir = "/tmp";
+};
+
+struct ExternalStats {
+  size_t runs = 0;           // runs written, merge passes included
+  size_t bytes_spilled = 0;  // bytes written to temp files
+  size_t merge_passes = 0;   // extra passes to cut down the fan-in
+  size_t peak_active = 0;    // most vertical lines crossing one y
+  size_t slabs = 0;          // sweeps in step 3, one per x-slab
+};
+
+// Smallest read buffer worth giving a run before merging runs down
+constexpr size_t EXTERNAL_MIN_READ = 64 << 10;
+// What one active line costs: an order statistics tree node with its malloc
+// header
+constexpr size_t EXTERNAL_ACTIVE_NODE_BYTES = 64;
+
+// A temp file, already unlinked, so it goes away with the process. Items
+// are appended and read back from a byte offset, so one file holds every
+// run of a sorter and a sorter keeps one descriptor however many runs it
+// writes.
+class SpillFile {
+public:
+  SpillFile() = default;
+  explicit SpillFile(const std::string &dir) {
+    std::string path = dir + "/plus_spill_XXXXXX";
+    fd = mkstemp(&path[0]);
+    if (fd < 0)
+      throw std::runtime_error("can't create a temp file in " + dir);
+    unlink(path.c_str());
+  }
+  SpillFile(SpillFile &&other) noexcept { *this = std::move(other); }
+  SpillFile &operator=(SpillFile &&other) noexcept {
+    std::swap(fd, other.fd);
+    std::swap(end, other.end);
+    return *this;
+  }
+  SpillFile(const SpillFile &) = delete;
+  SpillFile &operator=(const SpillFile &) = delete;
+  ~SpillFile() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  bool is_open() const { return fd >= 0; }
+
+  // Appends n items and returns the offset they start at
+  template <class T> size_t append(const T *items, size_t n) {
+    const size_t offset = end;
+    const char *bytes = reinterpret_cast<const char *>(items);
+    for (size_t left = n * sizeof(T); left > 0;) {
+      const ssize_t written = pwrite(fd, bytes, left, end);
+      if (written <= 0)
+        throw std::runtime_error("temp file write failed");
+      bytes += written;
+      left -= written;
+      end += written;
+    }
+    return offset;
+  }
+
+  template <class T> void read_at(T *items, size_t n, size_t offset) {
+    char *bytes = reinterpret_cast<char *>(items);
+    for (size_t left = n * sizeof(T); left > 0;) {
+      const ssize_t got = pread(fd, bytes, left, offset);
+      if (got <= 0)
+        throw std::runtime_error("temp file read failed");
+      bytes += got;
+      left -= got;
+      offset += got;
+    }
+  }
+
+private:
+  int fd = -1;
+  size_t end = 0;
+};
+
+// Sorts more items than fit in memory. push() everything, finish(), then
+// next() hands them back in order. Each buffer of input goes through
+// prepare(buffer, scratch), which must sort it by less and may shrink it
+// (merging lines), before it is written as a run.
+template <class T, class Less, class Prepare> class ExternalSorter {
+public:
+  ExternalSorter(const ExternalConfig &config, size_t budget,
+                 ExternalStats &stats, Less less, Prepare prepare)
+      : config(config), stats(stats), less(less), prepare(prepare) {
+    // The buffer and prepare's scratch share the budget
+    capacity = std::max<size_t>(budget / (2 * sizeof(T)), 1024);
+    buffer.reserve(capacity);
+  }
+
+  void push(const T &item) {
+    buffer.push_back(item);
+    if (buffer.size() == capacity)
+      spill();
+  }
+
+  // No more input: spills what is buffered and frees the buffers, so the
+  // sorter holds no memory until finish()
+  void seal() {
+    if (sealed)
+      return;
+    if (!buffer.empty() || runs.empty())
+      spill();
+    std::vector<T>().swap(buffer);
+    std::vector<T>().swap(scratch);
+    sealed = true;
+  }
+
+  // Seals and gets ready to read, with up to read_budget bytes of buffers.
+  // They are freed again once next() has handed back the last item, unless
+  // keep is set: then rewind() reads everything again and release() frees
+  // it.
+  void finish(size_t read_budget, bool keep = false) {
+    seal();
+
+    // Each pass merges consecutive groups of runs into a new file, which
+    // then replaces the old one, so at most two files are open at a time
+    const size_t fan_in =
+        std::max<size_t>(read_budget / EXTERNAL_MIN_READ, 2);
+    while (runs.size() > fan_in) {
+      SpillFile merged_file(config.temp_dir);
+      std::vector<Run> merged_runs, group;
+      std::vector<T> out;
+      out.reserve(std::max<size_t>(read_budget / 2 / sizeof(T), 1));
+      for (size_t first = 0; first < runs.size(); first += fan_in) {
+        group.assign(runs.begin() + first,
+                     runs.begin() + std::min(first + fan_in, runs.size()));
+        open_readers(group, read_budget / 2);
+        Run merged;
+        T item;
+        while (next(item)) {
+          out.push_back(item);
+          if (out.size() == out.capacity())
+            write_run_chunk(merged_file, merged, out);
+        }
+        write_run_chunk(merged_file, merged, out);
+        merged_runs.push_back(merged);
+        stats.runs++;
+        stats.merge_passes++;
+      }
+      file = std::move(merged_file);
+      runs.swap(merged_runs);
+    }
+    open_readers(runs, read_budget);
+    reread_budget = read_budget;
+    reading = true;
+    keep_runs = keep;
+  }
+
+  // Back to the first item, after finish(read_budget, true)
+  void rewind() { open_readers(runs, reread_budget); }
+
+  bool next(T &item) {
+    if (heap.empty()) {
+      if (reading && !keep_runs)
+        release();
+      return false;
+    }
+    std::pop_heap(heap.begin(), heap.end(), heap_order());
+    Reader &reader = *heap.back().second;
+    item = heap.back().first;
+    if (reader.next(heap.back().first))
+      std::push_heap(heap.begin(), heap.end(), heap_order());
+    else
+      heap.pop_back();
+    return true;
+  }
+
+  void release() {
+    reading = false;
+    std::vector<Reader>().swap(readers);
+    std::vector<std::pair<T, Reader *>>().swap(heap);
+    std::vector<Run>().swap(runs);
+    file = SpillFile();
+  }
+
+private:
+  // Items [offset, offset + count * sizeof(T)) of the sorter's file
+  struct Run {
+    size_t offset = 0;
+    size_t count = 0;
+  };
+
+  struct Reader {
+    SpillFile *file = nullptr;
+    std::vector<T> items;
+    size_t pos = 0, left = 0, offset = 0;
+
+    bool next(T &item) {
+      if (pos == items.size()) {
+        if (left == 0)
+          return false;
+        items.resize(std::min(left, items.capacity()));
+        file->read_at(items.data(), items.size(), offset);
+        offset += items.size() * sizeof(T);
+        left -= items.size();
+        pos = 0;
+      }
+      item = items[pos++];
+      return true;
+    }
+  };
+
+  const ExternalConfig &config;
+  ExternalStats &stats;
+  Less less;
+  Prepare prepare;
+  size_t capacity;
+  std::vector<T> buffer, scratch;
+  SpillFile file; // every run, opened at the first spill
+  std::vector<Run> runs;
+  std::vector<Reader> readers;
+  std::vector<std::pair<T, Reader *>> heap;
+  size_t reread_budget = 0;
+  bool sealed = false, reading = false, keep_runs = false;
+
+  // Heap order: smallest item on top, ties to the earlier run
+  bool after(const std::pair<T, Reader *> &l,
+             const std::pair<T, Reader *> &r) const {
+    if (less(r.first, l.first))
+      return true;
+    return !less(l.first, r.first) && r.second < l.second;
+  }
+  auto heap_order() const {
+    return [this](const std::pair<T, Reader *> &l,
+                  const std::pair<T, Reader *> &r) { return after(l, r); };
+  }
+
+  void spill() {
+    prepare(buffer, scratch);
+    if (!file.is_open())
+      file = SpillFile(config.temp_dir);
+    Run run;
+    write_run_chunk(file, run, buffer);
+    runs.push_back(run);
+    stats.runs++;
+  }
+
+  // Appends items to run, which must be the last run written to `to`
+  void write_run_chunk(SpillFile &to, Run &run, std::vector<T> &items) {
+    const size_t offset = to.append(items.data(), items.size());
+    if (run.count == 0)
+      run.offset = offset;
+    run.count += items.size();
+    stats.bytes_spilled += items.size() * sizeof(T);
+    items.clear();
+  }
+
+  void open_readers(std::vector<Run> &group, size_t budget) {
+    readers.assign(group.size(), Reader());
+    heap.clear();
+    const size_t per_run =
+        std::max<size_t>(budget / group.size() / sizeof(T), 1);
+    for (size_t i = 0; i < group.size(); i++) {
+      Reader &reader = readers[i];
+      reader.file = &file;
+      reader.offset = group[i].offset;
+      reader.left = group[i].count;
+      reader.items.reserve(per_run);
+      T first;
+      if (reader.next(first))
+        heap.emplace_back(first, &reader);
+    }
+    std::make_heap(heap.begin(), heap.end(), heap_order());
+  }
+};
+
+// Strokes in, plus sign count out
+class ExternalCounter {
+public:
+  explicit ExternalCounter(const ExternalConfig &config = ExternalConfig())
+      : config(config), vsorter(new_line_sorter(config.memory_budget / 2)),
+        hsorter(new_line_sorter(config.memory_budget / 2)),
+        builder(vbuffer, hbuffer) {}
+
+  // The sorters and the builder hold references into the counter
+  ExternalCounter(const ExternalCounter &) = delete;
+  ExternalCounter &operator=(const ExternalCounter &) = delete;
+  ExternalCounter(ExternalCounter &&) = delete;
+  ExternalCounter &operator=(ExternalCounter &&) = delete;
+
+  void step(char d, long long len) {
+    builder.step(d, len);
+    drain();
+  }
+
+  long long finish() {
+    builder.finish();
+    drain();
+
+    // 2. Vertical lines to events. The horizontal buffers go to disk first;
+    // then the vertical merge reads with a third of the budget while the
+    // two event buffers take the rest. The lines come in x order, so the
+    // slab edges are placed on the way: a new slab every max_active
+    // distinct x.
+    hsorter.seal();
+    const size_t third = config.memory_budget / 3;
+    const size_t quarter = config.memory_budget / 4;
+    const size_t max_active =
+        std::max<size_t>(quarter / EXTERNAL_ACTIVE_NODE_BYTES, 1);
+    vsorter.finish(third);
+    auto starts = new_event_sorter(third);
+    auto ends = new_event_sorter(third);
+    std::vector<long long> slab_edges; // first x of every slab but the first
+    size_t slab_xs = 0;
+    long long last_x = 0;
+    Interval vline;
+    for (LineStream lines(vsorter); lines.next(vline);) {
+      if (vline.s == vline.e)
+        continue; // nothing inside, and its end would come before its start
+      if (slab_xs == 0 || vline.a != last_x) {
+        if (slab_xs == max_active) {
+          slab_edges.push_back(vline.a);
+          slab_xs = 0;
+        }
+        slab_xs++;
+        last_x = vline.a;
+      }
+      starts.push({vline.s, vline.a});
+      ends.push({vline.e, vline.a});
+    }
+
+    // 3. Sweep y upwards through the horizontal lines, once per slab. The
+    // vertical readers were freed when their stream ran dry, and the event
+    // buffers go to disk before any reader is opened, so the three merges
+    // get a quarter each and the active set, at most max_active lines, the
+    // last quarter.
+    starts.seal();
+    ends.seal();
+    const bool slabs = !slab_edges.empty();
+    hsorter.finish(quarter, slabs);
+    starts.finish(quarter, slabs);
+    ends.finish(quarter, slabs);
+    long long nplus = 0;
+    for (size_t slab = 0; slab <= slab_edges.size(); slab++) {
+      if (slab > 0) {
+        hsorter.rewind();
+        starts.rewind();
+        ends.rewind();
+      }
+      nplus += sweep(starts, ends, slab_edges, slab);
+    }
+    if (slabs) {
+      hsorter.release();
+      starts.release();
+      ends.release();
+    }
+    stats_.slabs = slab_edges.size() + 1;
+    return nplus;
+  }
+
+  const ExternalStats &stats() const { return stats_; }
+
+private:
+  // Sort a buffer of strokes and merge it into lines
+  struct PrepareLines {
+    void operator()(std::vector<Interval> &run,
+                    std::vector<Interval> &scratch) const {
+      sort_by_anchor_start(run, scratch);
+      scratch.clear();
+      merge_intervals(run, scratch);
+      run.swap(scratch);
+    }
+  };
+  struct PrepareEvents {
+    void operator()(std::vector<std::pair<long long, long long>> &run,
+                    std::vector<std::pair<long long, long long>> &scratch)
+        const {
+      radix_sort(
+          run, scratch,
+          [](const std::pair<long long, long long> &e) { return e.first; },
+          [](const std::pair<long long, long long> &e) { return e.second; });
+    }
+  };
+  using LineSorter =
+      ExternalSorter<Interval, bool (*)(const Interval &, const Interval &),
+                     PrepareLines>;
+  using EventLess = std::less<std::pair<long long, long long>>;
+  using EventSorter =
+      ExternalSorter<std::pair<long long, long long>, EventLess, PrepareEvents>;
+
+  // merge_intervals over a sorted stream of runs that are merged already
+  class LineStream {
+  public:
+    explicit LineStream(LineSorter &sorter) : sorter(sorter) {
+      has_current = sorter.next(current);
+    }
+
+    bool next(Interval &line) {
+      while (has_current) {
+        Interval item;
+        bool more;
+        while ((more = sorter.next(item)) && item == current)
+          current = current.merge(item);
+        line = current;
+        has_current = more;
+        if (more)
+          current = item;
+        if (line.a != 0 || line.s != 0 || line.e != 0)
+          return true;
+      }
+      return false;
+    }
+
+  private:
+    LineSorter &sorter;
+    Interval current;
+    bool has_current;
+  };
+
+  ExternalConfig config;
+  ExternalStats stats_;
+  LineSorter vsorter, hsorter;
+  std::vector<Interval> vbuffer, hbuffer;
+  StrokeBuilder builder;
+
+  LineSorter new_line_sorter(size_t budget) {
+    return LineSorter(config, budget, stats_, by_anchor_start, PrepareLines());
+  }
+  EventSorter new_event_sorter(size_t budget) {
+    return EventSorter(config, budget, stats_, EventLess(), PrepareEvents());
+  }
+
+  // One pass of step 3 over the vertical lines with x in slab, which is
+  // [slab_edges[slab - 1], slab_edges[slab]) with the ends left open
+  long long sweep(EventSorter &starts, EventSorter &ends,
+                  const std::vector<long long> &slab_edges, size_t slab) {
+    auto in_slab = [&](long long x) {
+      return (slab == 0 || slab_edges[slab - 1] <= x) &&
+             (slab == slab_edges.size() || x < slab_edges[slab]);
+    };
+    __gnu_pbds::tree<long long, __gnu_pbds::null_type, std::less<long long>,
+                     __gnu_pbds::rb_tree_tag,
+                     __gnu_pbds::tree_order_statistics_node_update>
+        active;
+    std::pair<long long, long long> start, end;
+    bool has_start = starts.next(start), has_end = ends.next(end);
+    long long nplus = 0;
+    Interval hline;
+    for (LineStream lines(hsorter); lines.next(hline);) {
+      // A vertical line is active on (s, e). Events go in key order, so a
+      // line ending before another starts on the same x is removed first.
+      for (;;) {
+        if (has_end && end.first <= hline.a &&
+            !(has_start && start.first < hline.a && start.first < end.first)) {
+          if (in_slab(end.second))
+            active.erase(end.second);
+          has_end = ends.next(end);
+        } else if (has_start && start.first < hline.a) {
+          if (in_slab(start.second))
+            active.insert(start.second);
+          has_start = starts.next(start);
+        } else {
+          break;
+        }
+      }
+      stats_.peak_active = std::max(stats_.peak_active, active.size());
+      if (hline.s + 1 < hline.e)
+        nplus += active.order_of_key(hline.e) -
+                 active.order_of_key(hline.s + 1);
+    }
+    return nplus;
+  }
+
+  // Hands the strokes StrokeBuilder just made to the sorters
+  void drain() {
+    for (const Interval &stroke : vbuffer)
+      vsorter.push(stroke);
+    for (const Interval &stroke : hbuffer)
+      hsorter.push(stroke);
+    vbuffer.clear();
+    hbuffer.clear();
+  }
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Open-addressing hash map in the style of a Swiss table: one control byte
+// per slot (empty, or 7 bits of the hash) in groups of 16, keys and values in
+// flat arrays beside it. A probe compares a whole group of control bytes at
+// once and only touches keys whose 7 bits match, so there is no per-entry
+// heap node and a lookup is usually one or two cache lines.
+//
+// Entries are never erased, which is all the plus sign variants need, so
+// there are no tombstones either.
+
+// Finalizer of splitmix64: every input bit affects every output bit, so
+// neighbouring coordinates don't land in neighbouring slots
+inline uint64_t hash_mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t v) {
+  return hash_mix(seed + 0x9e3779b97f4a7c15ULL + hash_mix(v));
+}
+
+struct MixHash {
+  size_t operator()(long long v) const { return hash_mix(v); }
+};
+
+template <class K, class V, class Hash = MixHash> class FlatHashMap {
+public:
+  FlatHashMap() = default;
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  void clear() {
+    ctrl.assign(ctrl.size(), EMPTY);
+    count = 0;
+  }
+
+  // Makes room for n entries without rehashing
+  void reserve(size_t n) {
+    size_t groups = 1;
+    while (groups * GROUP * 7 / 8 < n)
+      groups *= 2;
+    if (groups * GROUP > ctrl.size())
+      rehash(groups);
+  }
+
+  V *find(const K &key) {
+    size_t slot = locate(key, Hash()(key));
+    return slot == NPOS ? nullptr : &values[slot];
+  }
+
+  const V *find(const K &key) const {
+    size_t slot = locate(key, Hash()(key));
+    return slot == NPOS ? nullptr : &values[slot];
+  }
+
+  bool contains(const K &key) const { return find(key) != nullptr; }
+
+  // Inserts key with a default value if missing; returns the value and
+  // whether it was inserted
+  std::pair<V *, bool> try_emplace(const K &key) {
+    uint64_t h = Hash()(key);
+    size_t slot = locate(key, h);
+    if (slot != NPOS)
+      return {&values[slot], false};
+    if ((count + 1) * 8 > ctrl.size() * 7)
+      rehash(ctrl.empty() ? 1 : ctrl.size() / GROUP * 2);
+    slot = insert_new(key, h);
+    values[slot] = V();
+    return {&values[slot], true};
+  }
+
+  V &operator[](const K &key) { return *try_emplace(key).first; }
+
+  // Visits the entries in slot order
+  class const_iterator {
+  public:
+    const_iterator(const FlatHashMap *map, size_t i) : map(map), i(i) {
+      skip();
+    }
+    std::pair<const K &, const V &> operator*() const {
+      return {map->keys[i], map->values[i]};
+    }
+    const_iterator &operator++() {
+      i++;
+      skip();
+      return *this;
+    }
+    bool operator!=(const const_iterator &other) const { return i != other.i; }
+
+  private:
+    const FlatHashMap *map;
+    size_t i;
+
+    void skip() {
+      while (i < map->ctrl.size() && map->ctrl[i] == EMPTY)
+        i++;
+    }
+  };
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, ctrl.size()); }
+
+private:
+  static constexpr size_t GROUP = 16;
+  static constexpr size_t NPOS = ~size_t(0);
+  static constexpr int8_t EMPTY = -128;
+
+  std::vector<int8_t> ctrl; // EMPTY or the low 7 bits of the hash
+  std::vector<K> keys;
+  std::vector<V> values;
+  size_t count = 0;
+
+  static int8_t tag(uint64_t h) { return h & 0x7f; }
+
+  // Bit i set when ctrl[base + i] == byte
+  uint32_t match(size_t base, int8_t byte) const {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(ctrl.data() + base));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP; i++)
+      mask |= uint32_t(ctrl[base + i] == byte) << i;
+    return mask;
+#endif
+  }
+
+  // Groups are visited in triangular order, which covers every group when
+  // the group count is a power of two
+  size_t locate(const K &key, uint64_t h) const {
+    if (ctrl.empty())
+      return NPOS;
+    const size_t mask = ctrl.size() / GROUP - 1;
+    size_t g = (h >> 7) & mask;
+    for (size_t step = 1;; step++) {
+      size_t base = g * GROUP;
+      for (uint32_t m = match(base, tag(h)); m; m &= m - 1) {
+        size_t slot = base + __builtin_ctz(m);
+        if (keys[slot] == key)
+          return slot;
+      }
+      if (match(base, EMPTY))
+        return NPOS;
+      g = (g + step) & mask;
+    }
+  }
+
+  // key must not be present and there must be a free slot
+  size_t insert_new(const K &key, uint64_t h) {
+    const size_t mask = ctrl.size() / GROUP - 1;
+    size_t g = (h >> 7) & mask;
+    for (size_t step = 1;; step++) {
+      size_t base = g * GROUP;
+      if (uint32_t m = match(base, EMPTY)) {
+        size_t slot = base + __builtin_ctz(m);
+        ctrl[slot] = tag(h);
+        keys[slot] = key;
+        count++;
+        return slot;
+      }
+      g = (g + step) & mask;
+    }
+  }
+
+  void rehash(size_t groups) {
+    std::vector<int8_t> old_ctrl(groups * GROUP, EMPTY);
+    std::vector<K> old_keys(groups * GROUP);
+    std::vector<V> old_values(groups * GROUP);
+    old_ctrl.swap(ctrl);
+    old_keys.swap(keys);
+    old_values.swap(values);
+    count = 0;
+    for (size_t i = 0; i < old_ctrl.size(); i++) {
+      if (old_ctrl[i] != EMPTY) {
+        size_t slot = insert_new(old_keys[i], Hash()(old_keys[i]));
+        values[slot] = std::move(old_values[i]);
+      }
+    }
+  }
+};
+
+// Set on top of the map; the one byte value is the only overhead
+template <class K, class Hash = MixHash> class FlatHashSet {
+  using Map = FlatHashMap<K, char, Hash>;
+
+public:
+  size_t size() const { return map.size(); }
+  bool empty() const { return map.empty(); }
+  void clear() { map.clear(); }
+  void reserve(size_t n) { map.reserve(n); }
+  bool contains(const K &key) const { return map.contains(key); }
+
+  // Returns whether key was new
+  bool insert(const K &key) { return map.try_emplace(key).second; }
+
+  class const_iterator {
+  public:
+    explicit const_iterator(typename Map::const_iterator it) : it(it) {}
+    const K &operator*() const { return (*it).first; }
+    const_iterator &operator++() {
+      ++it;
+      return *this;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return it != other.it;
+    }
+
+  private:
+    typename Map::const_iterator it;
+  };
+
+  const_iterator begin() const { return const_iterator(map.begin()); }
+  const_iterator end() const { return const_iterator(map.end()); }
+
+private:
+  Map map;
+};
@@ -1,10 +1,12 @@
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "flat_hash.h"
+
 using namespace std;
 
 struct Interval {
@@ -94,15 +96,15 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
   long long nplus = 0;
   long long h_idx = 0;
   const long long h_size = hstrokes.size();
-  unordered_map<long long, Interval> prev_v;
-  unordered_map<long long, Interval> prev_h;
+  FlatHashMap<long long, Interval> prev_v;
+  FlatHashMap<long long, Interval> prev_h;
 
   // Worst case O(V*H) to count number of plus signs
   for (long long i = 0; i < vstrokes.size(); i++) {
     Interval vstroke = vstrokes[i];
     // O(1) to merge overlapping vertical strokes
-    if (prev_v.find(vstroke.a) != prev_v.end()) {
-      vstroke = vstroke.merge(prev_v[vstroke.a]);
+    if (const Interval *prev = prev_v.find(vstroke.a)) {
+      vstroke = vstroke.merge(*prev);
     }
     prev_v[vstroke.a] = vstroke;
 
@@ -113,8 +115,8 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
     // Worst case O(H) to count number of plus signs
     for (long long j = h_idx; j < h_size && hstrokes[j].a < vstroke.e; j++) {
       Interval hstroke = hstrokes[j];
-      if (prev_h.find(hstroke.a) != prev_h.end()) {
-        hstroke = hstroke.merge(prev_h[hstroke.a]);
+      if (const Interval *prev = prev_h.find(hstroke.a)) {
+        hstroke = hstroke.merge(*prev);
       }
       prev_h[hstroke.a] = hstroke;
 
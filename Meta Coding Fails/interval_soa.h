@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PLUS_SIGN_X86 1
+#endif
+
+#include "plus_sign.h"
+
+// Structure-of-arrays copy of an Interval vector. The crossing test in the
+// window scan only needs s and e, so keeping a/s/e in separate arrays means
+// each cache line carries eight useful values instead of two and a third.
+struct IntervalSoA {
+  std::vector<long long> a, s, e;
+
+  void assign(const std::vector<Interval> &intervals) {
+    const size_t n = intervals.size();
+    a.resize(n);
+    s.resize(n);
+    e.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = intervals[i].a;
+      s[i] = intervals[i].s;
+      e[i] = intervals[i].e;
+    }
+  }
+
+  size_t size() const { return a.size(); }
+};
+
+// Number of i in [0, n) with s[i] < x < e[i]
+using CrossingKernel = long long (*)(const long long *s, const long long *e,
+                                     size_t n, long long x);
+
+inline long long count_covering_scalar(const long long *s, const long long *e,
+                                       size_t n, long long x) {
+  long long hits = 0;
+  for (size_t i = 0; i < n; i++)
+    hits += (s[i] < x) & (x < e[i]);
+  return hits;
+}
+
+#ifdef PLUS_SIGN_X86
+__attribute__((target("avx2,popcnt"))) inline long long
+count_covering_avx2(const long long *s, const long long *e, size_t n,
+                    long long x) {
+  const __m256i xv = _mm256_set1_epi64x(x);
+  long long hits = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i sv = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i ev = _mm256_loadu_si256((const __m256i *)(e + i));
+    __m256i inside = _mm256_and_si256(_mm256_cmpgt_epi64(xv, sv),
+                                      _mm256_cmpgt_epi64(ev, xv));
+    hits += _mm_popcnt_u32(_mm256_movemask_pd(_mm256_castsi256_pd(inside)));
+  }
+  return hits + count_covering_scalar(s + i, e + i, n - i, x);
+}
+
+__attribute__((target("avx512f,popcnt"))) inline long long
+count_covering_avx512(const long long *s, const long long *e, size_t n,
+                      long long x) {
+  const __m512i xv = _mm512_set1_epi64(x);
+  long long hits = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512i sv = _mm512_loadu_si512(s + i);
+    __m512i ev = _mm512_loadu_si512(e + i);
+    __mmask8 inside = _mm512_cmpgt_epi64_mask(xv, sv) &
+                      _mm512_cmpgt_epi64_mask(ev, xv);
+    hits += _mm_popcnt_u32(inside);
+  }
+  return hits + count_covering_scalar(s + i, e + i, n - i, x);
+}
+#endif
+
+// Picks the widest kernel the CPU supports, once
+inline CrossingKernel crossing_kernel() {
+  static const CrossingKernel kernel = [] {
+#ifdef PLUS_SIGN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return count_covering_avx512;
+    if (__builtin_cpu_supports("avx2"))
+      return count_covering_avx2;
+#endif
+    return count_covering_scalar;
+  }();
+  return kernel;
+}
+
+inline const char *crossing_kernel_name() {
+  CrossingKernel kernel = crossing_kernel();
+#ifdef PLUS_SIGN_X86
+  if (kernel == count_covering_avx512)
+    return "avx512";
+  if (kernel == count_covering_avx2)
+    return "avx2";
+#endif
+  return kernel == count_covering_scalar ? "scalar" : "?";
+}
@@ -1,11 +1,14 @@
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <stdio.h>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "arena.h"
+#include "flat_hash.h"
+
 using namespace std;
 
 struct Node {
@@ -13,22 +16,11 @@ struct Node {
   long long e;
   Node *next;
 };
-// Calculate proper alignment for Node struct
-constexpr size_t NODE_ALIGN = alignof(Node);
-// Round up the size to ensure proper alignment
-constexpr size_t NODE_SIZE =
-    (sizeof(Node) + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
-// Aligned memory array
-alignas(Node) static char memory[NODE_SIZE * 2000000];
-static size_t midx = 0;        // memory index
-static size_t inc = NODE_SIZE; // memory increment
+// Node storage; grows on demand and is reset at the start of every call
+static Arena arena(2 << 20, true);
 
 // Helper to get aligned pointer to new node
-Node *getNode() {
-  Node *node = reinterpret_cast<Node *>(memory + midx);
-  midx += inc;
-  return node;
-}
+Node *getNode() { return arena.create<Node>(); }
 
 Node *insert(Node *head, long long s, long long e) {
   Node *new_node = getNode();
@@ -82,12 +74,50 @@ Node *insert(Node *head, long long s, long long e) {
   return head;
 }
 
+// Read-only copy of the vertical lines, built once ingestion is done. The
+// anchors are sorted and the merged intervals of anchors[i] are
+// starts/ends[offsets[i], offsets[i + 1]), sorted and disjoint, so a point
+// lookup is two binary searches over contiguous arrays.
+struct AnchorIndex {
+  vector<long long> anchors;
+  vector<size_t> offsets;
+  vector<long long> starts, ends;
+
+  void build(const map<long long, Node *> &lines) {
+    anchors.clear();
+    offsets.assign(1, 0);
+    starts.clear();
+    ends.clear();
+    for (const auto &[a, head] : lines) {
+      if (!head)
+        continue;
+      anchors.push_back(a);
+      for (Node *n = head; n; n = n->next) {
+        starts.push_back(n->s);
+        ends.push_back(n->e);
+      }
+      offsets.push_back(starts.size());
+    }
+  }
+
+  // Whether some interval of anchors[i] has s < p < e
+  bool covers(size_t i, long long p) const {
+    auto first = starts.begin() + offsets[i];
+    auto last = starts.begin() + offsets[i + 1];
+    // Last interval starting before p
+    auto it = lower_bound(first, last, p);
+    if (it == first)
+      return false;
+    return p < ends[it - starts.begin() - 1];
+  }
+};
+
 long long getPlusSignCount(int N, vector<int> L, string D) {
-  memset(memory, 0, sizeof(memory));
+  arena.reset();
   long long x = 0, y = 0;
   long long nplus = 0;
   map<long long, Node *> vlines;
-  unordered_map<long long, Node *> hlines;
+  FlatHashMap<long long, Node *> hlines;
 
   long long m = 0;
   for (int i = 0; i < N; i++) {
@@ -116,26 +146,25 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
     m = 0;
   }
 
-  Node *v, *h;
-  long long x1, x2, y1, y2;
+  AnchorIndex vindex;
+  vindex.build(vlines);
+
+  Node *h;
+  long long x1, x2;
   for (const auto &[y, hhead] : hlines) {
     h = hhead;
     while (h) {
       x1 = h->s, x2 = h->e;
-      auto px1 = vlines.lower_bound(x1), px2 = vlines.upper_bound(x2);
-      for (auto it = px1; it != px2; ++it) {
-        const auto &[x, vhead] = *it;
-        if (x <= x1 || x >= x2)
-          continue;
-        v = vhead;
-        while (v) {
-          y1 = v->s, y2 = v->e;
-          if (y1 < y && y < y2) {
-            nplus++;
-            break;
-          }
-          v = v->next;
-        }
+      // Vertical anchors strictly inside (x1, x2)
+      size_t first = upper_bound(vindex.anchors.begin(), vindex.anchors.end(),
+                                 x1) -
+                     vindex.anchors.begin();
+      size_t last = lower_bound(vindex.anchors.begin() + first,
+                                vindex.anchors.end(), x2) -
+                    vindex.anchors.begin();
+      for (size_t i = first; i < last; i++) {
+        if (vindex.covers(i, y))
+          nplus++;
       }
       h = h->next;
     }
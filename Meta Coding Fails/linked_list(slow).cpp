@@ -6,6 +6,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "arena.h"
+
 using namespace std;
 
 struct Node {
@@ -13,22 +15,11 @@ struct Node {
   long long e;
   Node *next;
 };
-// Calculate proper alignment for Node struct
-constexpr size_t NODE_ALIGN = alignof(Node);
-// Round up the size to ensure proper alignment
-constexpr size_t NODE_SIZE =
-    (sizeof(Node) + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
-// Aligned memory array
-alignas(Node) static char memory[NODE_SIZE * 2000000];
-static size_t midx = 0;        // memory index
-static size_t inc = NODE_SIZE; // memory increment
+// Node storage; grows on demand and is reset at the start of every call
+static Arena arena(2 << 20, true);
 
 // Helper to get aligned pointer to new node
-Node *getNode() {
-  Node *node = reinterpret_cast<Node *>(memory + midx);
-  midx += inc;
-  return node;
-}
+Node *getNode() { return arena.create<Node>(); }
 
 Node *insert(Node *head, long long s, long long e) {
   Node *new_node = getNode();
@@ -83,7 +74,7 @@ Node *insert(Node *head, long long s, long long e) {
 }
 
 long long getPlusSignCount(int N, vector<int> L, string D) {
-  memset(memory, 0, sizeof(memory));
+  arena.reset();
   long long x = 0, y = 0;
   long long nplus = 0;
   map<long long, Node *> vlines;
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A whole file mapped read-only, for readers that walk it front to back
+struct MappedFile {
+  const char *data = nullptr;
+  size_t size = 0;
+
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const char *path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      ::close(fd);
+      return false;
+    }
+    size = st.st_size;
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+      size = 0;
+      return false;
+    }
+    data = static_cast<const char *>(mapped);
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    return true;
+  }
+
+  // Drops the resident pages of [from, to) once the cursor is past them
+  void release(const char *from, const char *to) const {
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t lo = (reinterpret_cast<uintptr_t>(from) + page - 1) & ~(page - 1);
+    uintptr_t hi = reinterpret_cast<uintptr_t>(to) & ~(page - 1);
+    if (lo < hi)
+      madvise(reinterpret_cast<void *>(lo), hi - lo, MADV_DONTNEED);
+  }
+
+  ~MappedFile() {
+    if (data)
+      munmap(const_cast<char *>(data), size);
+  }
+};
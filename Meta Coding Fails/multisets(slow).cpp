@@ -1,9 +1,13 @@
 #include <iostream>
 #include <iterator>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "arena_resource.h"
+#include "plus_stats.h"
+
 using namespace std;
 
 struct Interval {
@@ -42,12 +46,20 @@ struct CompareByStartAnchor {
   }
 };
 
-using MultisetByAnchor = multiset<Interval, CompareByAnchorStart>;
-using SetByAnchor = set<Interval, CompareByAnchorStart>;
-using SetByStart = set<Interval, CompareByStartAnchor>;
+using MultisetByAnchor = pmr::multiset<Interval, CompareByAnchorStart>;
+using SetByAnchor = pmr::set<Interval, CompareByAnchorStart>;
+using SetByStart = pmr::set<Interval, CompareByStartAnchor>;
+
+// Set for the _heap copies engines.h includes; see plus_node_resource
+#ifdef PLUS_HEAP_NODES
+constexpr bool heap_nodes = true;
+#else
+constexpr bool heap_nodes = false;
+#endif
 
-SetByAnchor to_anchor_set(MultisetByAnchor container) {
-  SetByAnchor result;
+// The result uses the container's memory resource
+SetByAnchor to_anchor_set(const MultisetByAnchor &container) {
+  SetByAnchor result(container.get_allocator().resource());
   if (container.empty())
     return result;
   Interval current = *container.begin();
@@ -67,8 +79,8 @@ SetByAnchor to_anchor_set(MultisetByAnchor container) {
   return result;
 }
 
-SetByStart to_start_set(MultisetByAnchor container) {
-  SetByStart result;
+SetByStart to_start_set(const MultisetByAnchor &container) {
+  SetByStart result(container.get_allocator().resource());
   if (container.empty())
     return result;
   Interval current = *container.begin();
@@ -110,9 +122,11 @@ void printSet(const SetByStart &container) {
 }
 
 long long getPlusSignCount(int N, vector<int> L, string D) {
+  PLUS_STATS_BEGIN();
+  pmr::memory_resource *nodes = plus_node_resource(heap_nodes);
   long long x = 0, y = 0, m = 0;
-  MultisetByAnchor all_vlines;
-  MultisetByAnchor all_hlines;
+  MultisetByAnchor all_vlines(nodes);
+  MultisetByAnchor all_hlines(nodes);
 
   for (int i = 0; i < N; i++) {
     m += L[i];
@@ -139,9 +153,15 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
     }
     m = 0;
   }
+  PLUS_LAP(build);
+  PLUS_STAT_ADD(vstrokes, all_vlines.size());
+  PLUS_STAT_ADD(hstrokes, all_hlines.size());
 
   SetByAnchor hlines = to_anchor_set(all_hlines);
   SetByStart vlines = to_start_set(all_vlines);
+  PLUS_LAP(merge);
+  PLUS_STAT_ADD(vlines, vlines.size());
+  PLUS_STAT_ADD(hlines, hlines.size());
   long long nplus = 0;
   auto hline_it = hlines.begin();
   for (const Interval &vline : vlines) {
@@ -153,6 +173,7 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
     // Check all horizontal lines that could intersect with current vertical
     auto current_h = hline_it;
     while (current_h != hlines.end() && current_h->a < vline.e) {
+      PLUS_STAT_ADD(candidates, 1);
       // Check if horizontal and vertical lines actually intersect
       if (current_h->s < vline.a && vline.a < current_h->e) {
         nplus++;
@@ -160,6 +181,9 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
       current_h++;
     }
   }
+  PLUS_LAP(count);
+  PLUS_STAT_ADD(crossings, nplus);
+  PLUS_STATS_END(heap_nodes ? "multisets_heap" : "multisets");
   return nplus;
 }
 
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dominance_index.h"
+
+using namespace std;
+
+// Keeps the merged lines as ordered per-anchor interval maps, like
+// IntervalSet in sets(incorrect).cpp, and keeps the plus count up to date as
+// strokes are appended.
+//
+// Merging only ever grows a line, so a stroke never removes a plus sign. The
+// new ones are exactly the integer points that become strictly interior to
+// the merged line (the gaps it fills plus old endpoints it swallows) and are
+// already strictly interior to a perpendicular line.
+//
+// Those points are counted with a DominanceIndex per axis. A merged piece
+// (a, s, e) is stored as +1 at (a, s + 1) and -1 at (a, e), so summing the
+// weights with anchor in [lo, hi] and coord <= at counts the pieces with
+// s < at < e. Erasing a piece adds the opposite weights.
+//
+// An append is O(log N) amortized for the merge (each piece is erased at
+// most once) and O(log^2 N) amortized for the count.
+class OnlinePlusCounter {
+public:
+  // Draws a stroke from the current pen position; returns the running count
+  long long append(char direction, long long length) {
+    switch (direction) {
+    case 'U':
+      add_line(vertical, horizontal, x, y, y + length);
+      y += length;
+      break;
+    case 'D':
+      add_line(vertical, horizontal, x, y - length, y);
+      y -= length;
+      break;
+    case 'L':
+      add_line(horizontal, vertical, y, x - length, x);
+      x -= length;
+      break;
+    case 'R':
+      add_line(horizontal, vertical, y, x, x + length);
+      x += length;
+      break;
+    }
+    return nplus;
+  }
+
+  long long count() const { return nplus; }
+
+private:
+  using Pieces = map<long long, long long>; // start -> end, disjoint
+  using Lines = map<long long, Pieces>;      // anchor -> merged pieces
+
+  struct Axis {
+    Lines lines;
+    DominanceIndex index;
+
+    void add(long long anchor, long long s, long long e, long long sign) {
+      index.add(anchor, s + 1, sign);
+      index.add(anchor, e, -sign);
+    }
+  };
+
+  Axis vertical, horizontal;
+  long long x = 0, y = 0, nplus = 0;
+  vector<pair<long long, long long>> fresh;
+
+  void add_line(Axis &axis, const Axis &across, long long anchor, long long s,
+                long long e) {
+    // A zero-length stroke has no interior and can't join two pieces that
+    // don't already touch
+    if (s == e)
+      return;
+    fresh.clear();
+    merge_piece(axis, anchor, s, e, fresh);
+    // Lines across anchored in [lo, hi] that have `anchor` strictly inside
+    for (const auto &[lo, hi] : fresh)
+      nplus += across.index.sum(lo, hi, anchor);
+  }
+
+  // Merges [s, e] into the pieces and appends the integer ranges [lo, hi]
+  // that were not strictly interior before and are now
+  static void merge_piece(Axis &axis, long long anchor, long long s,
+                          long long e,
+                          vector<pair<long long, long long>> &fresh) {
+    Pieces &pieces = axis.lines[anchor];
+    // First piece that can overlap or touch [s, e]
+    auto it = pieces.upper_bound(s);
+    if (it != pieces.begin() && prev(it)->second >= s)
+      --it;
+    if (it != pieces.end() && it->first <= s && it->second >= e)
+      return;
+
+    long long ms = s, me = e;
+    auto last = it;
+    while (last != pieces.end() && last->first <= e) {
+      ms = min(ms, last->first);
+      me = max(me, last->second);
+      ++last;
+    }
+
+    long long cur = ms + 1;
+    for (auto p = it; p != last; ++p) {
+      if (cur <= p->first)
+        fresh.emplace_back(cur, p->first);
+      cur = max(cur, p->second);
+    }
+    if (cur <= me - 1)
+      fresh.emplace_back(cur, me - 1);
+
+    for (auto p = it; p != last; ++p)
+      axis.add(anchor, p->first, p->second, -1);
+    axis.add(anchor, ms, me, 1);
+    pieces.erase(it, last);
+    pieces.emplace(ms, me);
+  }
+};
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  OnlinePlusCounter counter;
+  for (int i = 0; i < N; i++)
+    counter.append(D[i], L[i]);
+  return counter.count();
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // A zero-length vertical stroke in the middle of a horizontal line
+  N = 3;
+  L = {2, 0, 1};
+  D = "LUL";
+  expected = 0;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parallel_merge.h"
+#include "parallel_strokes.h"
+#include "plus_sign.h"
+
+using namespace std;
+
+// Splits the merged horizontal lines (sorted by anchor) into contiguous bands
+// and sweeps each band on its own thread, starting from the vertical lines
+// already active at its first line. Band edges are placed on the running sum
+// of "horizontal lines + vertical lines first seen here", which is the work a
+// band's sweep does, so a dense stretch of the drawing gets narrower bands.
+//
+// Every horizontal line belongs to exactly one band, so the partial counts
+// add up to what count_crossings_sweep returns.
+long long count_crossings_bands(const vector<Interval> &hlines,
+                                const vector<Interval> &vlines,
+                                unsigned threads) {
+  const size_t h_size = hlines.size();
+  if (threads <= 1 || h_size < 2 * threads || vlines.empty())
+    return count_crossings_sweep(hlines, vlines);
+
+  // Rank of each vertical anchor; vlines are sorted by anchor
+  vector<long long> xs;
+  vector<int> vrank(vlines.size());
+  for (size_t i = 0; i < vlines.size(); i++) {
+    if (xs.empty() || xs.back() != vlines[i].a)
+      xs.push_back(vlines[i].a);
+    vrank[i] = xs.size() - 1;
+  }
+
+  // Vertical line indices in activation and deactivation order, shared by
+  // every band. A zero-length line has nothing inside it, and a band edge
+  // could fall between its end and its start.
+  vector<int> starts, ends;
+  for (size_t i = 0; i < vlines.size(); i++) {
+    if (vlines[i].s == vlines[i].e)
+      continue;
+    starts.push_back(i);
+    ends.push_back(i);
+  }
+  vector<int> scratch;
+  radix_sort(starts, scratch, [&](int v) { return vlines[v].s; });
+  radix_sort(ends, scratch, [&](int v) { return vlines[v].e; });
+
+  // Horizontal line index range [vlo, vhi) each vertical line can cross:
+  // the first line above s and the first at or above e. Both come from
+  // walking the sorted events up the horizontal lines; zero-length lines
+  // keep an empty range.
+  vector<size_t> vlo(vlines.size(), 0), vhi(vlines.size(), 0);
+  vector<long long> weight(h_size + 1, 1);
+  size_t h = 0;
+  for (int v : starts) {
+    for (; h < h_size && hlines[h].a <= vlines[v].s; h++)
+      ;
+    vlo[v] = h;
+  }
+  h = 0;
+  for (int v : ends) {
+    for (; h < h_size && hlines[h].a < vlines[v].e; h++)
+      ;
+    vhi[v] = h;
+  }
+  for (int v : starts)
+    if (vlo[v] < vhi[v])
+      weight[vlo[v]]++;
+
+  long long total = 0;
+  for (size_t i = 0; i < h_size; i++)
+    total += weight[i];
+
+  vector<size_t> edges = {0};
+  long long running = 0;
+  for (size_t i = 0; i < h_size && edges.size() < threads; i++) {
+    running += weight[i];
+    if (running * (long long)threads >= total * (long long)edges.size())
+      edges.push_back(i + 1);
+  }
+  edges.push_back(h_size);
+  edges.erase(unique(edges.begin(), edges.end()), edges.end());
+  const size_t bands = edges.size() - 1;
+
+  // The lines active at each band's first horizontal line, from one pass
+  // over the events: the count per anchor rank is copied out at every band
+  // edge into that band's tree, O(V + bands * X) in all. The band then
+  // replays only the events from its first line on.
+  vector<Fenwick> seeds(bands);
+  vector<size_t> first_start(bands), first_end(bands);
+  vector<int> active_at(xs.size(), 0);
+  size_t si = 0, ei = 0;
+  for (size_t band = 0; band < bands; band++) {
+    const long long a0 = hlines[edges[band]].a;
+    for (; si < starts.size() && vlines[starts[si]].s < a0; si++)
+      active_at[vrank[starts[si]]]++;
+    for (; ei < ends.size() && vlines[ends[ei]].e <= a0; ei++)
+      active_at[vrank[ends[ei]]]--;
+    seeds[band].reset(xs.size());
+    copy(active_at.begin(), active_at.end(), seeds[band].tree.begin() + 1);
+    first_start[band] = si;
+    first_end[band] = ei;
+  }
+
+  vector<long long> partial(bands, 0);
+  auto count_band = [&](size_t band) {
+    Fenwick &active = seeds[band];
+    active.build();
+    size_t si = first_start[band], ei = first_end[band];
+    long long nplus = 0;
+    for (size_t i = edges[band]; i < edges[band + 1]; i++) {
+      const Interval &hline = hlines[i];
+      for (; si < starts.size() && vlines[starts[si]].s < hline.a; si++)
+        active.add(vrank[starts[si]], 1);
+      for (; ei < ends.size() && vlines[ends[ei]].e <= hline.a; ei++)
+        active.add(vrank[ends[ei]], -1);
+
+      size_t lo = upper_bound(xs.begin(), xs.end(), hline.s) - xs.begin();
+      size_t hi = lower_bound(xs.begin(), xs.end(), hline.e) - xs.begin();
+      if (lo < hi)
+        nplus += active.prefix(hi) - active.prefix(lo);
+    }
+    partial[band] = nplus;
+  };
+
+  vector<thread> workers;
+  for (size_t band = 1; band < bands; band++)
+    workers.emplace_back(count_band, band);
+  count_band(0);
+  for (thread &worker : workers)
+    worker.join();
+
+  long long nplus = 0;
+  for (long long count : partial)
+    nplus += count;
+  return nplus;
+}
+
+long long count_plus_bands(int N, const vector<int> &L, const string &D,
+                           unsigned threads) {
+  vector<Interval> vstrokes, hstrokes, vlines, hlines;
+  build_strokes_parallel(N, L, D, vstrokes, hstrokes, threads);
+
+  sort_merge_parallel(hstrokes, hlines, threads);
+  sort_merge_parallel(vstrokes, vlines, threads);
+
+  return count_crossings_bands(hlines, vlines, threads);
+}
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  return count_plus_bands(N, L, D, thread::hardware_concurrency());
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // A staircase with a zero-length vertical line on one stair, in 2, 3 and
+  // 4 bands whatever this machine has
+  N = 22;
+  L = {2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 1, 0, 1, 1, 2, 1};
+  D = "RDRDRDRDRDRDRDRDRURDRD";
+  expected = 0;
+  for (unsigned threads = 2; threads <= 4; threads++) {
+    result = count_plus_bands(N, L, D, threads);
+    cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "plus_sign.h"
+
+// sort_by_anchor_start + merge_intervals split over threads, with the same
+// output byte for byte.
+//
+// Sorting is a sample sort: splitters drawn from the strokes cut the (a, s)
+// key space into one bucket per thread, every thread scatters its slice of
+// the input into the buckets (in input order, so the whole thing stays
+// stable) and then radix sorts one bucket.
+//
+// Merging is a segmented scan. Sorted by (a, s), stroke i starts a new line
+// unless it has the anchor of stroke i - 1 and s <= M(i), the largest e seen
+// so far on that anchor; a line's e is M just after its last stroke. M is a
+// prefix max that restarts at every anchor change, which is associative, so
+// each bucket can be scanned on its own once it knows the (anchor, M) carried
+// in from the buckets before it. Lines are emitted by the bucket they start
+// in; a line that runs on into later buckets gets its final e in a short
+// serial stitch.
+
+// Below this many strokes per thread the serial path is used
+constexpr size_t PARALLEL_MERGE_MIN_SLICE = 1 << 16;
+
+namespace parallel_merge_detail {
+
+inline bool key_less(const Interval &l, const Interval &r) {
+  return l.a != r.a ? l.a < r.a : l.s < r.s;
+}
+
+template <class Work> void run_parts(size_t parts, Work work) {
+  std::vector<std::thread> workers;
+  for (size_t p = 1; p < parts; p++)
+    workers.emplace_back(work, p);
+  work(0);
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+// What a bucket looks like from outside: where its trailing anchor segment
+// stands, and where its first line start is
+struct Summary {
+  bool empty = true;
+  long long first_a = 0, last_a = 0;
+  long long tail_max = 0; // max e over the trailing anchor segment
+  bool single_anchor = true;
+};
+
+struct Carry {
+  bool valid = false;
+  long long a = 0, max_e = 0;
+};
+
+} // namespace parallel_merge_detail
+
+inline void sort_merge_parallel(std::vector<Interval> &strokes,
+                                std::vector<Interval> &lines,
+                                unsigned threads) {
+  using namespace parallel_merge_detail;
+  const size_t n = strokes.size();
+  const size_t parts = std::min<size_t>(threads, n / PARALLEL_MERGE_MIN_SLICE);
+  if (parts <= 1) {
+    std::vector<Interval> scratch;
+    sort_by_anchor_start(strokes, scratch);
+    merge_intervals(strokes, lines);
+    return;
+  }
+
+  // Splitters from an evenly spaced sample
+  std::vector<Interval> sample;
+  const size_t per_part = 64;
+  for (size_t i = 0; i < parts * per_part; i++)
+    sample.push_back(strokes[i * n / (parts * per_part)]);
+  std::sort(sample.begin(), sample.end(), key_less);
+  std::vector<Interval> splitters;
+  for (size_t p = 1; p < parts; p++)
+    splitters.push_back(sample[p * per_part]);
+  auto bucket_of = [&](const Interval &stroke) {
+    return std::upper_bound(splitters.begin(), splitters.end(), stroke,
+                            key_less) -
+           splitters.begin();
+  };
+
+  // counts[t][b]: strokes of input slice t going to bucket b
+  std::vector<std::vector<size_t>> counts(parts,
+                                          std::vector<size_t>(parts, 0));
+  std::vector<unsigned> bucket(n);
+  run_parts(parts, [&](size_t t) {
+    for (size_t i = n * t / parts; i < n * (t + 1) / parts; i++)
+      counts[t][bucket[i] = bucket_of(strokes[i])]++;
+  });
+
+  std::vector<std::vector<Interval>> buckets(parts);
+  for (size_t b = 0; b < parts; b++) {
+    size_t total = 0;
+    for (size_t t = 0; t < parts; t++) {
+      size_t c = counts[t][b];
+      counts[t][b] = total;
+      total += c;
+    }
+    buckets[b].resize(total);
+  }
+  run_parts(parts, [&](size_t t) {
+    for (size_t i = n * t / parts; i < n * (t + 1) / parts; i++)
+      buckets[bucket[i]][counts[t][bucket[i]]++] = strokes[i];
+  });
+  std::vector<unsigned>().swap(bucket);
+
+  std::vector<Summary> summary(parts);
+  run_parts(parts, [&](size_t b) {
+    std::vector<Interval> scratch;
+    sort_by_anchor_start(buckets[b], scratch);
+    const std::vector<Interval> &v = buckets[b];
+    Summary &sm = summary[b];
+    if (v.empty())
+      return;
+    sm.empty = false;
+    sm.first_a = v.front().a;
+    sm.last_a = v.back().a;
+    sm.single_anchor = sm.first_a == sm.last_a;
+    sm.tail_max = v.back().e;
+    for (size_t i = v.size() - 1; i-- > 0 && v[i].a == sm.last_a;)
+      sm.tail_max = std::max(sm.tail_max, v[i].e);
+  });
+
+  // Carry into each bucket: the anchor and M of everything before it
+  std::vector<Carry> carry(parts);
+  for (size_t b = 1; b < parts; b++) {
+    carry[b] = carry[b - 1];
+    const Summary &sm = summary[b - 1];
+    if (sm.empty)
+      continue;
+    if (sm.single_anchor && carry[b].valid && carry[b].a == sm.last_a)
+      carry[b].max_e = std::max(carry[b].max_e, sm.tail_max);
+    else
+      carry[b] = {true, sm.last_a, sm.tail_max};
+  }
+
+  // Each bucket's lines; lead_max[b] is M after the strokes before the first
+  // start in bucket b (they extend the previous bucket's last line)
+  std::vector<std::vector<Interval>> parts_out(parts);
+  std::vector<char> has_start(parts, false);
+  std::vector<long long> lead_max(parts, 0);
+  run_parts(parts, [&](size_t b) {
+    const std::vector<Interval> &v = buckets[b];
+    std::vector<Interval> &out = parts_out[b];
+    bool valid = carry[b].valid;
+    long long a = carry[b].a, max_e = carry[b].max_e;
+    for (const Interval &stroke : v) {
+      const bool starts = !valid || stroke.a != a || stroke.s > max_e;
+      if (starts) {
+        if (!has_start[b])
+          lead_max[b] = max_e;
+        has_start[b] = true;
+        out.push_back(stroke);
+        valid = true;
+        a = stroke.a;
+        max_e = stroke.e;
+      } else {
+        max_e = std::max(max_e, stroke.e);
+        if (has_start[b])
+          out.back().e = max_e;
+      }
+    }
+    if (!has_start[b])
+      lead_max[b] = max_e;
+    std::vector<Interval>().swap(buckets[b]);
+  });
+
+  // Stitch: a bucket's last line ends where the next start is
+  for (size_t b = 0; b < parts; b++) {
+    if (parts_out[b].empty())
+      continue;
+    Interval &last = parts_out[b].back();
+    for (size_t next = b + 1; next < parts; next++) {
+      if (summary[next].empty)
+        continue;
+      last.e = std::max(last.e, lead_max[next]);
+      if (has_start[next])
+        break;
+    }
+  }
+
+  // merge_intervals drops (0, 0, 0) lines
+  auto zero = [](const Interval &line) {
+    return line.a == 0 && line.s == 0 && line.e == 0;
+  };
+  std::vector<size_t> offset(parts + 1, lines.size());
+  for (size_t b = 0; b < parts; b++) {
+    std::vector<Interval> &out = parts_out[b];
+    out.erase(std::remove_if(out.begin(), out.end(), zero), out.end());
+    offset[b + 1] = offset[b] + out.size();
+  }
+  lines.resize(offset[parts]);
+  run_parts(parts, [&](size_t b) {
+    std::copy(parts_out[b].begin(), parts_out[b].end(),
+              lines.begin() + offset[b]);
+  });
+}
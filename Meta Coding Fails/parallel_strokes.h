@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plus_sign.h"
+
+// build_strokes split over threads. Each chunk of L/D is independent once
+// its starting pen position is known, and that is an exclusive scan of the
+// chunks' net moves:
+//
+//   1. every thread sums the (dx, dy) of its chunk
+//   2. a serial scan over the chunk sums gives each chunk's start
+//   3. every thread builds its chunk's strokes from that start
+//   4. the per-chunk strokes are copied into place, in parallel
+//
+// Chunk edges are moved forward to the next run start, so a run that would
+// straddle an edge is built whole by the chunk it starts in and the output is
+// exactly what build_strokes produces.
+
+// Chunks smaller than this aren't worth a thread
+constexpr size_t PARALLEL_STROKES_MIN_CHUNK = 1 << 16;
+
+inline void build_strokes_parallel(int N, const std::vector<int> &L,
+                                   const std::string &D,
+                                   std::vector<Interval> &vstrokes,
+                                   std::vector<Interval> &hstrokes,
+                                   unsigned threads) {
+  const size_t n = N;
+  const size_t chunks =
+      std::min<size_t>(threads, n / PARALLEL_STROKES_MIN_CHUNK);
+  if (chunks <= 1) {
+    build_strokes(N, L, D, vstrokes, hstrokes);
+    return;
+  }
+
+  std::vector<size_t> edges(chunks + 1);
+  for (size_t c = 0; c <= chunks; c++) {
+    size_t edge = std::max(n * c / chunks, c ? edges[c - 1] : 0);
+    while (edge > 0 && edge < n && D[edge] == D[edge - 1])
+      edge++;
+    edges[c] = edge;
+  }
+
+  auto run_chunks = [&](auto work) {
+    std::vector<std::thread> workers;
+    for (size_t c = 1; c < chunks; c++)
+      workers.emplace_back(work, c);
+    work(0);
+    for (std::thread &worker : workers)
+      worker.join();
+  };
+
+  // 1. Net move of each chunk
+  std::vector<long long> start_x(chunks + 1, 0), start_y(chunks + 1, 0);
+  run_chunks([&](size_t c) {
+    long long dx = 0, dy = 0;
+    for (size_t i = edges[c]; i < edges[c + 1]; i++) {
+      const DirectionStep step = direction_table.steps[(unsigned char)D[i]];
+      dx += step.dx * (long long)L[i];
+      dy += step.dy * (long long)L[i];
+    }
+    start_x[c + 1] = dx;
+    start_y[c + 1] = dy;
+  });
+
+  // 2. Exclusive scan
+  for (size_t c = 1; c <= chunks; c++) {
+    start_x[c] += start_x[c - 1];
+    start_y[c] += start_y[c - 1];
+  }
+
+  // 3. Strokes of each chunk
+  std::vector<std::vector<Interval>> vparts(chunks), hparts(chunks);
+  run_chunks([&](size_t c) {
+    const size_t begin = edges[c], len = edges[c + 1] - begin;
+    vparts[c].reserve(len);
+    hparts[c].reserve(len);
+    build_strokes_range(L.data() + begin, D.data() + begin, len, start_x[c],
+                        start_y[c], vparts[c], hparts[c]);
+  });
+
+  // 4. Concatenate
+  std::vector<size_t> voffset(chunks + 1, vstrokes.size()),
+      hoffset(chunks + 1, hstrokes.size());
+  for (size_t c = 0; c < chunks; c++) {
+    voffset[c + 1] = voffset[c] + vparts[c].size();
+    hoffset[c + 1] = hoffset[c] + hparts[c].size();
+  }
+  vstrokes.resize(voffset[chunks]);
+  hstrokes.resize(hoffset[chunks]);
+  run_chunks([&](size_t c) {
+    std::copy(vparts[c].begin(), vparts[c].end(),
+              vstrokes.begin() + voffset[c]);
+    std::copy(hparts[c].begin(), hparts[c].end(),
+              hstrokes.begin() + hoffset[c]);
+    std::vector<Interval>().swap(vparts[c]);
+    std::vector<Interval>().swap(hparts[c]);
+  });
+}
@@ -0,0 +1,150 @@
+// Counts drawings with PlusPipeline (plus_pipeline.h), parse, build,
+// sort/merge and count overlapping on four threads.
+//
+//   g++ -std=c++17 -O2 -pthread -I. -o pipeline_count pipeline_count.cpp
+//   ./pipeline_count drawings.txt [more.txt ...]
+//   ./pipeline_count [drawings per shape] [strokes per drawing]
+//
+// Files hold drawings in the text format of drawing_gen.h, one after
+// another; their counts go to stdout and stage stats to stderr. With numbers
+// or no arguments it runs the usual three cases, then times a generated
+// batch read from text one drawing after another and through the pipeline.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "plus_batch.h"
+#include "plus_pipeline.h"
+
+using namespace std;
+
+static void print_stats(ostream &out, const PlusPipeline &pipeline) {
+  char line[128];
+  snprintf(line, sizeof(line), "%-6s %8s %10s %10s %10s %12s\n", "stage",
+           "items", "busy_ms", "starved_ms", "blocked_ms", "drawings/s");
+  out << line;
+  for (const PipelineStage &st : pipeline.stats()) {
+    snprintf(line, sizeof(line), "%-6s %8zu %10.1f %10.1f %10.1f %12.0f\n",
+             st.name, st.items, st.busy_ms, st.starved_ms, st.blocked_ms,
+             st.throughput());
+    out << line;
+  }
+}
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  static PlusPipeline pipeline(1);
+  bool given = false;
+  long long result = 0;
+  pipeline.run(
+      [&](Drawing &d) {
+        if (given)
+          return false;
+        d.N = N;
+        d.L = move(L);
+        d.D = move(D);
+        return given = true;
+      },
+      [&](size_t, long long count) { result = count; });
+  return result;
+}
+
+// A whole argument of digits, so 100k.txt is a file and 0 is a count
+static bool is_count(const char *arg) {
+  char *end = nullptr;
+  strtoull(arg, &end, 10);
+  return *arg >= '0' && *arg <= '9' && *end == '\0';
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1 && !is_count(argv[1])) {
+    PlusPipeline pipeline;
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+      ifstream in(argv[i]);
+      if (!in) {
+        cerr << argv[i] << ": can't open\n";
+        status = 1;
+        continue;
+      }
+      pipeline.run_text(in, [&](size_t k, long long count) {
+        cout << argv[i] << " #" << k << ": " << count << "\n";
+      });
+      if (!in.eof()) {
+        cerr << argv[i] << ": stopped at something that isn't a drawing\n";
+        status = 1;
+      }
+      cerr << argv[i] << ":\n";
+      print_stats(cerr, pipeline);
+    }
+    return status;
+  }
+
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  size_t per_shape = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20;
+  int strokes = argc > 2 ? atoi(argv[2]) : 100000;
+  ostringstream text;
+  uint64_t seed = 1;
+  for (Shape shape : all_shapes) {
+    for (size_t i = 0; i < per_shape; i++)
+      write_drawing(text, generate_drawing(shape, strokes, seed++));
+  }
+  const string batch = text.str();
+
+  istringstream serial_in(batch);
+  PlusScratch scratch;
+  Drawing d;
+  vector<long long> serial;
+  auto start = chrono::steady_clock::now();
+  while (read_drawing(serial_in, d))
+    serial.push_back(scratch.count(d));
+  double serial_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+
+  istringstream piped_in(batch);
+  PlusPipeline pipeline;
+  vector<long long> piped;
+  start = chrono::steady_clock::now();
+  pipeline.run_text(piped_in, [&](size_t, long long count) {
+    piped.push_back(count);
+  });
+  double piped_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+
+  cout << serial.size() << " drawings of " << strokes
+       << " strokes: one at a time " << serial_ms << " ms, pipelined "
+       << piped_ms << " ms (" << thread::hardware_concurrency()
+       << " hardware threads)\n";
+  print_stats(cout, pipeline);
+  bool same = serial == piped;
+  cout << "Pipelined counts " << (same ? "match" : "differ") << "\n";
+  return !same;
+}
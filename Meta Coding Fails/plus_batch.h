@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "plus_sign.h"
+
+// Everything one sweep_fenwick count needs. Vectors are cleared, never
+// shrunk, so once they have grown to the largest drawing seen, counting
+// another drawing doesn't allocate. Cache line aligned so threads with
+// neighbouring scratches don't share a line.
+//
+// count() is build(), merge() and count_lines() in a row; they are separate
+// so a pipeline can run them on different threads.
+struct alignas(64) PlusScratch {
+  std::vector<Interval> vstrokes, hstrokes, vlines, hlines, sort;
+  SweepScratch sweep;
+
+  long long count(const Drawing &d) {
+    build(d);
+    merge();
+    return count_lines();
+  }
+
+  void build(const Drawing &d) {
+    vstrokes.clear();
+    hstrokes.clear();
+    build_strokes(d.N, d.L, d.D, vstrokes, hstrokes);
+  }
+
+  void merge() {
+    vlines.clear();
+    hlines.clear();
+    sort_by_anchor_start(hstrokes, sort);
+    merge_intervals(hstrokes, hlines);
+    sort_by_anchor_start(vstrokes, sort);
+    merge_intervals(vstrokes, vlines);
+  }
+
+  long long count_lines() {
+    return count_crossings_sweep(hlines, vlines, sweep);
+  }
+};
+
+// Counts many drawings on a fixed set of threads. The calling thread works
+// too, so `threads` is the total; each thread keeps its PlusScratch between
+// drawings and between batches. Drawings are handed out in small grains off
+// a shared cursor, which balances uneven sizes without a queue.
+class BatchCounter {
+public:
+  explicit BatchCounter(unsigned threads = std::thread::hardware_concurrency())
+      : scratch(std::max(1u, threads)) {
+    for (unsigned id = 1; id < scratch.size(); id++)
+      workers.emplace_back([this, id] { work(id); });
+  }
+
+  BatchCounter(const BatchCounter &) = delete;
+  BatchCounter &operator=(const BatchCounter &) = delete;
+
+  ~BatchCounter() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      stop = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+  // counts[i] = plus signs of drawings[i], for i in [0, n)
+  void count(const Drawing *drawings, size_t n, long long *counts) {
+    if (workers.empty() || n <= GRAIN) {
+      for (size_t i = 0; i < n; i++)
+        counts[i] = scratch[0].count(drawings[i]);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m);
+      batch = drawings;
+      batch_size = n;
+      out = counts;
+      next = 0;
+      busy = workers.size();
+      generation++;
+    }
+    wake.notify_all();
+    drain(scratch[0]);
+
+    std::unique_lock<std::mutex> lock(m);
+    done.wait(lock, [this] { return busy == 0; });
+  }
+
+  std::vector<long long> count(const std::vector<Drawing> &drawings) {
+    std::vector<long long> counts(drawings.size());
+    count(drawings.data(), drawings.size(), counts.data());
+    return counts;
+  }
+
+  unsigned threads() const { return scratch.size(); }
+
+private:
+  static constexpr size_t GRAIN = 16;
+
+  std::vector<PlusScratch> scratch; // one per thread, [0] is the caller's
+  std::vector<std::thread> workers;
+
+  std::mutex m;
+  std::condition_variable wake, done;
+  const Drawing *batch = nullptr;
+  size_t batch_size = 0;
+  long long *out = nullptr;
+  std::atomic<size_t> next{0};
+  size_t generation = 0;
+  size_t busy = 0;
+  bool stop = false;
+
+  void drain(PlusScratch &sc) {
+    for (;;) {
+      size_t begin = next.fetch_add(GRAIN, std::memory_order_relaxed);
+      if (begin >= batch_size)
+        return;
+      size_t end = std::min(begin + GRAIN, batch_size);
+      for (size_t i = begin; i < end; i++)
+        out[i] = sc.count(batch[i]);
+    }
+  }
+
+  void work(unsigned id) {
+    size_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(m);
+        wake.wait(lock, [&] { return stop || generation != seen; });
+        if (stop)
+          return;
+        seen = generation;
+      }
+      drain(scratch[id]);
+      {
+        std::lock_guard<std::mutex> lock(m);
+        busy--;
+      }
+      done.notify_one();
+    }
+  }
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "plus_sign.h"
+
+// A common face for the getPlusSignCount variants, a registry of them, and a
+// selector that picks one per drawing from a few cheap features.
+//
+//   EngineRegistry registry;
+//   registry.add({"sweep_fenwick", sweep_fenwick::getPlusSignCount, true});
+//   long long n = registry.count(N, L, D); // measure, select, run
+//
+// engines.h registers every variant in this directory. force() (or
+// PLUS_ENGINE in the environment, for engine_registry()) pins one engine
+// for every call, which is how the benchmark times a single engine behind
+// the same entry point.
+
+using PlusSignFn = long long (*)(int, std::vector<int>, std::string);
+
+struct PlusEngine {
+  const char *name;
+  PlusSignFn count;
+  bool exact; // agrees with the reference on every drawing; only these are
+              // ever selected
+};
+
+// Measured on the strokes themselves, after joining runs. Crossings and
+// candidates are estimates from a sample of strokes spread evenly along the
+// walk: the sampled horizontal strokes are ranked by anchor, and each
+// sampled vertical stroke is checked against the ones whose rank falls in
+// its span. A long step only adds one stroke to that, where a bounding box
+// would be stretched by it.
+//
+// scan_bound is not an estimate: no y-window scan visits more pairs. It is
+// hruns * vruns unless the sample leaves a scan in the running; then every
+// horizontal anchor goes in a bucket on an even grid over the anchor range
+// and each vertical stroke adds up the buckets its span touches.
+struct DrawingFeatures {
+  long long n = 0;
+  long long turns = 0;                // steps with a new direction
+  long long hruns = 0, vruns = 0;     // strokes after joining runs
+  long long hsample = 0, vsample = 0; // strokes the estimates come from
+  double crossings = 0;  // sampled crossings, scaled to every pair
+  double candidates = 0; // pairs a y-window scan visits, likewise
+  double scan_bound = 0; // at least the pairs a y-window scan visits
+
+  double density() const { return n > 0 ? crossings / n : 0; }
+};
+
+// The sample keeps this many to twice as many strokes of each direction,
+// or all of them
+constexpr long long FEATURE_SAMPLE = 1024;
+// Pairs per step a y-window scan may visit, by scan_bound, to be picked
+constexpr double SCAN_PAIRS = 32;
+
+namespace plus_engine_detail {
+
+// Calls f(step, a, s, e) for each stroke of the walk, runs joined
+template <class F>
+void for_each_stroke(int N, const std::vector<int> &L, const std::string &D,
+                     F f) {
+  long long x = 0, y = 0, m = 0;
+  for (int i = 0; i < N; i++) {
+    m += L[i];
+    if (i + 1 < N && D[i + 1] == D[i])
+      continue;
+    const DirectionStep step = direction_table.steps[(unsigned char)D[i]];
+    if (step.horizontal)
+      f(step, y, std::min(x, x + step.dx * m), std::max(x, x + step.dx * m));
+    else if (step.vertical)
+      f(step, x, std::min(y, y + step.dy * m), std::max(y, y + step.dy * m));
+    x += step.dx * m;
+    y += step.dy * m;
+    m = 0;
+  }
+}
+
+// Every stride-th stroke offered. When more than twice FEATURE_SAMPLE are
+// kept the stride doubles and every other kept stroke goes, so the sample
+// stays spread evenly over the whole walk.
+struct StrokeSample {
+  std::vector<std::pair<long long, Interval>> kept; // stroke number, stroke
+  long long seen = 0, stride = 1, next = 0;
+
+  void offer(const Interval &stroke) {
+    const long long index = seen++;
+    if (index != next)
+      return;
+    kept.push_back({index, stroke});
+    next += stride;
+    if ((long long)kept.size() > 2 * FEATURE_SAMPLE) {
+      stride *= 2;
+      kept.erase(std::remove_if(kept.begin(), kept.end(),
+                                [&](const std::pair<long long, Interval> &k) {
+                                  return k.first % stride != 0;
+                                }),
+                 kept.end());
+      next = (index / stride + 1) * stride;
+    }
+  }
+
+  std::vector<Interval> strokes() const {
+    std::vector<Interval> result;
+    for (const std::pair<long long, Interval> &k : kept)
+      result.push_back(k.second);
+    return result;
+  }
+};
+
+// Anchors of the sampled horizontal strokes ranked, then for each sampled
+// vertical stroke the ones strictly inside its span
+inline void estimate_from_sample(std::vector<Interval> &hs,
+                                 const std::vector<Interval> &vs,
+                                 DrawingFeatures &f) {
+  std::sort(hs.begin(), hs.end(),
+            [](const Interval &l, const Interval &r) { return l.a < r.a; });
+  long long candidates = 0, crossings = 0;
+  for (const Interval &v : vs) {
+    auto lo = std::upper_bound(
+        hs.begin(), hs.end(), v.s,
+        [](long long y, const Interval &h) { return y < h.a; });
+    for (auto it = lo; it != hs.end() && it->a < v.e; ++it) {
+      candidates++;
+      crossings += it->s < v.a && v.a < it->e;
+    }
+  }
+  if (hs.empty() || vs.empty())
+    return;
+  const double scale = (double)f.hruns / hs.size() * f.vruns / vs.size();
+  f.candidates = candidates * scale;
+  f.crossings = crossings * scale;
+}
+
+// Two more walks: horizontal anchors into buckets, then vertical spans over
+// them
+inline double scan_bound(int N, const std::vector<int> &L,
+                         const std::string &D, long long a_lo, long long a_hi,
+                         long long hruns) {
+  const long long buckets = std::max(1LL, std::min(hruns, a_hi - a_lo + 1));
+  const long long width = (a_hi - a_lo) / buckets + 1;
+  std::vector<long long> below(buckets + 1, 0);
+  for_each_stroke(N, L, D, [&](const DirectionStep &step, long long a,
+                               long long, long long) {
+    if (step.horizontal)
+      below[(a - a_lo) / width + 1]++;
+  });
+  for (long long b = 0; b < buckets; b++)
+    below[b + 1] += below[b];
+  double bound = 0;
+  for_each_stroke(N, L, D, [&](const DirectionStep &step, long long,
+                               long long s, long long e) {
+    if (!step.vertical || e < a_lo || s > a_hi)
+      return;
+    s = std::max(s, a_lo);
+    e = std::min(e, a_hi);
+    bound += below[(e - a_lo) / width + 1] - below[(s - a_lo) / width];
+  });
+  return bound;
+}
+
+} // namespace plus_engine_detail
+
+inline DrawingFeatures measure_features(int N, const std::vector<int> &L,
+                                        const std::string &D) {
+  using namespace plus_engine_detail;
+  DrawingFeatures f;
+  f.n = N;
+  StrokeSample hsample, vsample;
+  long long a_lo = 0, a_hi = -1;
+  for_each_stroke(N, L, D, [&](const DirectionStep &step, long long a,
+                               long long s, long long e) {
+    if (step.horizontal) {
+      a_lo = hsample.seen == 0 ? a : std::min(a_lo, a);
+      a_hi = hsample.seen == 0 ? a : std::max(a_hi, a);
+      hsample.offer(Interval(a, s, e));
+    } else {
+      vsample.offer(Interval(a, s, e));
+    }
+  });
+  f.hruns = hsample.seen;
+  f.vruns = vsample.seen;
+  f.turns = f.hruns + f.vruns;
+
+  std::vector<Interval> hs = hsample.strokes(), vs = vsample.strokes();
+  f.hsample = hs.size();
+  f.vsample = vs.size();
+  estimate_from_sample(hs, vs, f);
+
+  // Every pair is a bound too, and a free one. The walks for a tighter one
+  // are only worth it when a scan might be picked.
+  f.scan_bound = (double)f.hruns * f.vruns;
+  if (f.scan_bound > 4.0 * f.n + 1024 && f.candidates <= SCAN_PAIRS * f.n)
+    f.scan_bound =
+        std::min(f.scan_bound, scan_bound(N, L, D, a_lo, a_hi, f.hruns));
+  return f;
+}
+
+class EngineRegistry {
+public:
+  void add(const PlusEngine &engine) { list.push_back(engine); }
+
+  const std::vector<PlusEngine> &engines() const { return list; }
+
+  const PlusEngine *find(const std::string &name) const {
+    for (const PlusEngine &engine : list)
+      if (name == engine.name)
+        return &engine;
+    return nullptr;
+  }
+
+  // Every call goes to this engine; an empty name goes back to selecting.
+  // Returns false, changing nothing, for a name that isn't registered.
+  bool force(const std::string &name) {
+    if (!name.empty() && find(name) == nullptr)
+      return false;
+    forced = name;
+    return true;
+  }
+
+  const std::string &forced_engine() const { return forced; }
+
+  // The forced engine, else the choice for f, else the first exact engine
+  const PlusEngine *select(const DrawingFeatures &f) const {
+    if (!forced.empty())
+      return find(forced);
+    const PlusEngine *chosen = find(choose(f));
+    if (chosen != nullptr && chosen->exact)
+      return chosen;
+    for (const PlusEngine &engine : list)
+      if (engine.exact)
+        return &engine;
+    return nullptr;
+  }
+
+  long long count(int N, std::vector<int> L, std::string D) const {
+    const PlusEngine *engine = select(measure_features(N, L, D));
+    return engine != nullptr ? engine->count(N, std::move(L), std::move(D))
+                             : -1;
+  }
+
+  // The rules, from the benchmark on its five shapes. A y-window scan
+  // (vector, soa_avx2) visits every pair of a horizontal line and a vertical
+  // one spanning its anchor, O(H * V) at worst, so it is only picked when
+  // scan_bound, not an estimate, keeps that near linear:
+  //
+  //   - a plain scan does nothing else, and wins whenever the bound is
+  //     within a few pairs per step, as on a staircase;
+  //   - the SoA scan pays for its setup when windows are full but crossings
+  //     rare, as in walks of short strokes that come back over themselves;
+  //   - everything else goes to the 12-byte compact pipeline, which halves
+  //     the traffic of the sort and the sweep.
+  static const char *choose(const DrawingFeatures &f) {
+    if (f.scan_bound <= 4.0 * f.n + 1024)
+      return "vector";
+    if (f.scan_bound <= SCAN_PAIRS * f.n && f.candidates >= 8.0 * f.n &&
+        f.density() < 1)
+      return "soa_avx2";
+    return "compact_ranks";
+  }
+
+private:
+  std::vector<PlusEngine> list;
+  std::string forced;
+};
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "plus_sign.h"
+
+// Counts plus signs inside axis-aligned rectangles without listing them.
+// Built once from merged hlines/vlines in O(n log n); every query is four
+// O(log n) prefix lookups.
+//
+// D(X, Y), the number of crossings with x <= X and y <= Y, splits over the
+// horizontal lines h:
+//
+//   h.e <= X          all c_h crossings of h
+//   h.s < X < h.e     K(X, h.y) - K(h.s, h.y)
+//   X <= h.s          nothing
+//
+// where K(X, y) is the number of vertical lines with x <= X strictly around
+// height y. Write k_h = K(h.s, h.y). Then
+//
+//   D(X, Y) = sum over h.y <= Y of  W(h) + [h.s < X < h.e] * K(X, h.y)
+//
+// with W(h) = -k_h once X > h.s and c_h + k_h once X >= h.e. Sweeping X, a
+// segment tree over the heights of the horizontal lines keeps, per height, W,
+// the number of lines straddling X (at most one, lines are merged) and
+// K(X, y), which every vertical line bumps by one over its range. Each node
+// also keeps sum(straddling * K) for its subtree, so the bracketed product
+// can be summed over a prefix of heights. The tree is persistent: one root
+// per sweep position, with range adds kept in the nodes instead of pushed
+// down. A rectangle is then D by inclusion-exclusion.
+//
+// Memory is O(n log n) nodes of 32 bytes; updates made at the same sweep
+// position share nodes.
+class PlusIndex {
+public:
+  PlusIndex() = default;
+  PlusIndex(const std::vector<Interval> &hlines,
+            const std::vector<Interval> &vlines) {
+    build(hlines, vlines);
+  }
+
+  void build(const std::vector<Interval> &hlines,
+             const std::vector<Interval> &vlines) {
+    nodes.assign(1, Node());
+    at.clear();
+    roots.clear();
+    heights.clear();
+    for (const Interval &h : hlines)
+      heights.push_back(h.a);
+    std::sort(heights.begin(), heights.end());
+    heights.erase(std::unique(heights.begin(), heights.end()), heights.end());
+    if (heights.empty() || vlines.empty())
+      return;
+
+    std::vector<std::pair<long long, long long>> weight = line_weights(
+        hlines, vlines);
+
+    // Sweep events: a horizontal line starts straddling at s + 1 and stops at
+    // e, a vertical line raises K from its x on
+    struct Event {
+      long long x;
+      int line;     // index into hlines, or ~index into vlines
+      int straddle; // +1 or -1 for horizontal lines
+    };
+    std::vector<Event> events;
+    for (size_t i = 0; i < hlines.size(); i++) {
+      if (hlines[i].s == hlines[i].e)
+        continue; // no crossings, and s + 1 > e would invert its events
+      events.push_back({hlines[i].s + 1, (int)i, 1});
+      events.push_back({hlines[i].e, (int)i, -1});
+    }
+    for (size_t i = 0; i < vlines.size(); i++)
+      events.push_back({vlines[i].a, ~(int)i, 0});
+    std::sort(events.begin(), events.end(),
+              [](const Event &l, const Event &r) { return l.x < r.x; });
+
+    int root = 0;
+    for (size_t i = 0; i < events.size();) {
+      // Nodes made while applying one position's events are private to it
+      shared = nodes.size();
+      const long long x = events[i].x;
+      for (; i < events.size() && events[i].x == x; i++) {
+        const Event &ev = events[i];
+        if (ev.line < 0) {
+          const Interval &v = vlines[~ev.line];
+          size_t lo = std::upper_bound(heights.begin(), heights.end(), v.s) -
+                      heights.begin();
+          size_t hi = std::lower_bound(heights.begin(), heights.end(), v.e) -
+                      heights.begin();
+          if (lo < hi)
+            root = add_stabs(root, 0, heights.size(), lo, hi);
+        } else {
+          const Interval &h = hlines[ev.line];
+          size_t y = std::lower_bound(heights.begin(), heights.end(), h.a) -
+                     heights.begin();
+          long long w = ev.straddle > 0 ? -weight[ev.line].second
+                                        : weight[ev.line].first +
+                                              weight[ev.line].second;
+          root = add_line(root, 0, heights.size(), y, ev.straddle, w);
+        }
+      }
+      at.push_back(x);
+      roots.push_back(root);
+    }
+  }
+
+  // Plus signs with x1 <= x <= x2 and y1 <= y <= y2
+  long long count(long long x1, long long y1, long long x2,
+                  long long y2) const {
+    if (x1 > x2 || y1 > y2)
+      return 0;
+    return dominated(x2, y2) - dominated(x1 - 1, y2) - dominated(x2, y1 - 1) +
+           dominated(x1 - 1, y1 - 1);
+  }
+
+  // Plus signs with x <= X and y <= Y
+  long long dominated(long long X, long long Y) const {
+    size_t version = std::upper_bound(at.begin(), at.end(), X) - at.begin();
+    size_t prefix =
+        std::upper_bound(heights.begin(), heights.end(), Y) - heights.begin();
+    if (version == 0 || prefix == 0)
+      return 0;
+    return prefix_sum(roots[version - 1], 0, heights.size(), prefix, 0);
+  }
+
+  size_t node_count() const { return nodes.size(); }
+
+private:
+  struct Node {
+    int left = 0, right = 0;
+    int lines = 0;      // straddling lines in the subtree
+    int stabs = 0;      // K added to the whole subtree at this node
+    long long weight = 0;
+    long long product = 0; // sum of lines * K, counting adds at or below here
+  };
+
+  std::vector<Node> nodes; // nodes[0] is the empty tree
+  size_t shared = 0;       // nodes below this index belong to older roots
+  std::vector<long long> at;
+  std::vector<int> roots;
+  std::vector<long long> heights;
+
+  // (c_h, k_h) for every horizontal line, from one Fenwick sweep over x
+  std::vector<std::pair<long long, long long>>
+  line_weights(const std::vector<Interval> &hlines,
+               const std::vector<Interval> &vlines) const {
+    std::vector<std::pair<long long, long long>> weight(hlines.size());
+    std::vector<std::pair<long long, int>> queries; // (x, ~i at s or i at e-1)
+    for (size_t i = 0; i < hlines.size(); i++) {
+      queries.emplace_back(hlines[i].s, ~(int)i);
+      queries.emplace_back(hlines[i].e - 1, (int)i);
+    }
+    std::sort(queries.begin(), queries.end());
+    std::vector<int> order(vlines.size());
+    for (size_t i = 0; i < order.size(); i++)
+      order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](int l, int r) { return vlines[l].a < vlines[r].a; });
+
+    Fenwick stab; // difference array of K over the heights
+    stab.reset(heights.size() + 1);
+    size_t next = 0;
+    for (const auto &[x, q] : queries) {
+      for (; next < order.size() && vlines[order[next]].a <= x; next++) {
+        const Interval &v = vlines[order[next]];
+        if (v.s == v.e)
+          continue; // would add -1 at its own height
+        stab.add(std::upper_bound(heights.begin(), heights.end(), v.s) -
+                     heights.begin(),
+                 1);
+        stab.add(std::lower_bound(heights.begin(), heights.end(), v.e) -
+                     heights.begin(),
+                 -1);
+      }
+      const Interval &h = hlines[q < 0 ? ~q : q];
+      size_t y = std::lower_bound(heights.begin(), heights.end(), h.a) -
+                 heights.begin();
+      long long k = stab.prefix(y + 1);
+      if (q < 0)
+        weight[~q].second = k;
+      else
+        weight[q].first = k; // minus k_h below
+    }
+    for (auto &[c, k] : weight)
+      c -= k;
+    return weight;
+  }
+
+  int own(int i) {
+    if ((size_t)i >= shared && i != 0)
+      return i;
+    nodes.push_back(nodes[i]);
+    return nodes.size() - 1;
+  }
+
+  void pull(int i) {
+    Node &node = nodes[i];
+    const Node &l = nodes[node.left], &r = nodes[node.right];
+    node.lines = l.lines + r.lines;
+    node.weight = l.weight + r.weight;
+    node.product = l.product + r.product + (long long)node.stabs * node.lines;
+  }
+
+  int add_stabs(int i, size_t lo, size_t hi, size_t from, size_t to) {
+    i = own(i);
+    if (from <= lo && hi <= to) {
+      nodes[i].stabs++;
+      nodes[i].product += nodes[i].lines;
+      return i;
+    }
+    size_t mid = (lo + hi) / 2;
+    if (from < mid) {
+      int child = add_stabs(nodes[i].left, lo, mid, from, to);
+      nodes[i].left = child;
+    }
+    if (mid < to) {
+      int child = add_stabs(nodes[i].right, mid, hi, from, to);
+      nodes[i].right = child;
+    }
+    pull(i);
+    return i;
+  }
+
+  int add_line(int i, size_t lo, size_t hi, size_t y, int lines,
+               long long weight) {
+    i = own(i);
+    if (hi - lo == 1) {
+      Node &leaf = nodes[i];
+      leaf.lines += lines;
+      leaf.weight += weight;
+      leaf.product = (long long)leaf.lines * leaf.stabs;
+      return i;
+    }
+    size_t mid = (lo + hi) / 2;
+    if (y < mid) {
+      int child = add_line(nodes[i].left, lo, mid, y, lines, weight);
+      nodes[i].left = child;
+    } else {
+      int child = add_line(nodes[i].right, mid, hi, y, lines, weight);
+      nodes[i].right = child;
+    }
+    pull(i);
+    return i;
+  }
+
+  // Sum over the first `prefix` heights; stabs is K added above this node
+  long long prefix_sum(int i, size_t lo, size_t hi, size_t prefix,
+                       long long stabs) const {
+    const Node &node = nodes[i];
+    if (i == 0)
+      return 0;
+    if (hi <= prefix)
+      return node.weight + node.product + stabs * node.lines;
+    size_t mid = (lo + hi) / 2;
+    long long sum = prefix_sum(node.left, lo, mid, prefix, stabs + node.stabs);
+    if (mid < prefix)
+      sum += prefix_sum(node.right, mid, hi, prefix, stabs + node.stabs);
+    return sum;
+  }
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+#include "drawing_gen.h"
+#include "plus_batch.h"
+#include "spsc_queue.h"
+
+// Counts a stream of drawings with the four phases of a count on their own
+// threads, so they overlap: while drawing k is counted, k + 1 is being
+// merged, k + 2 built and k + 3 parsed.
+//
+//   parse -> build strokes -> sort/merge -> count
+//
+//   PlusPipeline pipeline;
+//   pipeline.run_text(input, [](size_t i, long long count) { ... });
+//
+// A drawing travels as a job holding its Drawing and PlusScratch, passed
+// between stages through SpscQueues. There are `depth` jobs, recycled from
+// the count stage back to the parser, so at most that many drawings are in
+// memory and, once their buffers have grown, nothing is allocated. Every
+// queue has room for all the jobs, so only the parser ever waits for room:
+// when a stage falls behind, the jobs pile up in front of it and the parser
+// waits for one to come back. That is the back-pressure.
+//
+// The caller's thread runs the count stage and the sink. Results come out in
+// input order.
+
+struct PipelineStage {
+  const char *name = "";
+  size_t items = 0;
+  double busy_ms = 0;    // CPU time of the stage's work
+  double starved_ms = 0; // waiting for the stage before
+  double blocked_ms = 0; // the parser waiting for a free job
+
+  // Drawings per CPU second, what the stage could do on a core of its own
+  double throughput() const {
+    return busy_ms > 0 ? items * 1000.0 / busy_ms : 0;
+  }
+};
+
+class PlusPipeline {
+public:
+  static constexpr size_t STAGES = 4;
+
+  explicit PlusPipeline(size_t depth = 4) {
+    for (size_t i = 0; i < std::max<size_t>(depth, 1); i++)
+      jobs.emplace_back(new Job());
+  }
+
+  PlusPipeline(const PlusPipeline &) = delete;
+  PlusPipeline &operator=(const PlusPipeline &) = delete;
+
+  // Pulls drawings with source(Drawing &) until it returns false and calls
+  // sink(index, count) for each one. Returns how many were counted.
+  template <class Source, class Sink> size_t run(Source source, Sink sink) {
+    static const char *const names[STAGES] = {"parse", "build", "merge",
+                                              "count"};
+    for (size_t s = 0; s < STAGES; s++) {
+      stages[s] = PipelineStage();
+      stages[s].name = names[s];
+    }
+    // One extra slot for the end marker (a null job)
+    for (SpscQueue<Job *> &queue : queues)
+      queue.reset(jobs.size() + 1);
+    for (const std::unique_ptr<Job> &job : jobs)
+      queues[FREE].try_push(job.get());
+
+    std::thread parser([&] { parse(source); });
+    std::thread builder([&] {
+      pass(queues[PARSED], queues[BUILT], stages[1],
+           [](Job &job) { job.scratch.build(job.drawing); });
+    });
+    std::thread merger([&] {
+      pass(queues[BUILT], queues[MERGED], stages[2],
+           [](Job &job) { job.scratch.merge(); });
+    });
+
+    PipelineStage &st = stages[3];
+    for (;;) {
+      Job *job = nullptr;
+      wait([&] { return queues[MERGED].try_pop(job); }, st.starved_ms);
+      if (job == nullptr)
+        break;
+      const double start = cpu_ms();
+      sink(job->index, job->scratch.count_lines());
+      st.busy_ms += cpu_ms() - start;
+      st.items++;
+      queues[FREE].try_push(job); // never full, it holds every job
+    }
+    parser.join();
+    builder.join();
+    merger.join();
+    return st.items;
+  }
+
+  // Reads drawings in the text format of drawing_gen.h until the stream
+  // ends or holds something else
+  template <class Sink> size_t run_text(std::istream &in, Sink sink) {
+    return run([&](Drawing &d) { return read_drawing(in, d); }, sink);
+  }
+
+  // Stats of the last run, one entry per stage in pipeline order
+  const std::array<PipelineStage, STAGES> &stats() const { return stages; }
+
+  size_t depth() const { return jobs.size(); }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    size_t index = 0;
+    Drawing drawing;
+    PlusScratch scratch;
+  };
+
+  // FREE runs from the count stage back to the parser
+  enum Queue { FREE, PARSED, BUILT, MERGED, QUEUES };
+
+  std::vector<std::unique_ptr<Job>> jobs;
+  std::array<SpscQueue<Job *>, QUEUES> queues;
+  std::array<PipelineStage, STAGES> stages;
+
+  static double since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+  }
+
+  // CPU time of the calling thread, so a stage sharing a core with the
+  // others isn't charged for their time slices
+  static double cpu_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+  }
+
+  // Retries attempt until it succeeds, adding the time spent to waited_ms.
+  // Spins briefly, then yields so a stage sharing a core can progress.
+  template <class Attempt>
+  static void wait(Attempt attempt, double &waited_ms) {
+    if (attempt())
+      return;
+    const auto start = Clock::now();
+    for (unsigned spins = 0; !attempt(); spins++)
+      if (spins >= 64)
+        std::this_thread::yield();
+    waited_ms += since(start);
+  }
+
+  template <class Source> void parse(Source &source) {
+    PipelineStage &st = stages[0];
+    for (size_t index = 0;; index++) {
+      Job *job = nullptr;
+      wait([&] { return queues[FREE].try_pop(job); }, st.blocked_ms);
+      const double start = cpu_ms();
+      const bool more = source(job->drawing);
+      st.busy_ms += cpu_ms() - start;
+      if (!more)
+        break;
+      job->index = index;
+      st.items++;
+      queues[PARSED].try_push(job); // room for every job
+    }
+    queues[PARSED].try_push(nullptr);
+  }
+
+  template <class Work>
+  void pass(SpscQueue<Job *> &in, SpscQueue<Job *> &out, PipelineStage &st,
+            Work work) {
+    for (;;) {
+      Job *job = nullptr;
+      wait([&] { return in.try_pop(job); }, st.starved_ms);
+      if (job != nullptr) {
+        const double start = cpu_ms();
+        work(*job);
+        st.busy_ms += cpu_ms() - start;
+        st.items++;
+      }
+      out.try_push(job); // room for every job
+      if (job == nullptr)
+        return;
+    }
+  }
+};
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "direction_runs.h"
+#include "radix_sort.h"
+
+// Shared pieces for the plus sign engines. The (slow)/(incorrect) variants
+// keep their own copies so they stay exactly as they were measured.
+
+struct Interval {
+  long long a, s, e;
+
+  Interval() : a(0), s(0), e(0) {}
+  Interval(long long a_, long long s_, long long e_) : a(a_), s(s_), e(e_) {}
+
+  Interval merge(const Interval &other) const {
+    return Interval(a, std::min(s, other.s), std::max(e, other.e));
+  }
+
+  // Same anchor and overlapping (touching counts as overlapping)
+  bool operator==(const Interval &other) const {
+    return a == other.a && !(s > other.e || other.s > e);
+  }
+
+  void print() const {
+    std::cout << "(" << a << "," << s << "," << e << ") ";
+  }
+};
+
+inline bool by_anchor_start(const Interval &lhs, const Interval &rhs) {
+  if (lhs.a != rhs.a)
+    return lhs.a < rhs.a;
+  return lhs.s < rhs.s;
+}
+
+inline bool by_start_anchor(const Interval &lhs, const Interval &rhs) {
+  if (lhs.s != rhs.s)
+    return lhs.s < rhs.s;
+  return lhs.a < rhs.a;
+}
+
+// Radix sorts for stroke arrays; see radix_sort.h
+inline void sort_by_anchor_start(std::vector<Interval> &intervals,
+                                 std::vector<Interval> &scratch) {
+  radix_sort(
+      intervals, scratch, [](const Interval &i) { return i.a; },
+      [](const Interval &i) { return i.s; });
+}
+
+inline void sort_by_start_anchor(std::vector<Interval> &intervals,
+                                 std::vector<Interval> &scratch) {
+  radix_sort(
+      intervals, scratch, [](const Interval &i) { return i.s; },
+      [](const Interval &i) { return i.a; });
+}
+
+inline void sort_by_anchor_start(std::vector<Interval> &intervals) {
+  std::vector<Interval> scratch;
+  sort_by_anchor_start(intervals, scratch);
+}
+
+inline void sort_by_start_anchor(std::vector<Interval> &intervals) {
+  std::vector<Interval> scratch;
+  sort_by_start_anchor(intervals, scratch);
+}
+
+// Expects intervals sorted by (a, s)
+inline void merge_intervals(std::vector<Interval> &intervals,
+                            std::vector<Interval> &result) {
+  if (intervals.empty())
+    return;
+
+  Interval current = intervals[0];
+  for (size_t i = 1; i < intervals.size(); i++) {
+    if (intervals[i] == current) {
+      current = current.merge(intervals[i]);
+    } else {
+      if (current.a != 0 || current.s != 0 || current.e != 0) {
+        result.push_back(current);
+      }
+      current = intervals[i];
+    }
+  }
+  if (current.a != 0 || current.s != 0 || current.e != 0) {
+    result.push_back(current);
+  }
+}
+
+// What a stroke in one direction does, so building strokes can look it up
+// instead of branching on the character. Anything but UDLR moves nowhere and
+// emits nothing.
+struct DirectionStep {
+  signed char dx, dy;
+  unsigned char vertical, horizontal;
+};
+
+template <char Dir> constexpr DirectionStep direction_step() {
+  return {Dir == 'R' ? 1 : Dir == 'L' ? -1 : 0,
+          Dir == 'U' ? 1 : Dir == 'D' ? -1 : 0, Dir == 'U' || Dir == 'D',
+          Dir == 'L' || Dir == 'R'};
+}
+
+struct DirectionTable {
+  DirectionStep steps[256] = {};
+
+  constexpr DirectionTable() {
+    steps[(unsigned char)'U'] = direction_step<'U'>();
+    steps[(unsigned char)'D'] = direction_step<'D'>();
+    steps[(unsigned char)'L'] = direction_step<'L'>();
+    steps[(unsigned char)'R'] = direction_step<'R'>();
+  }
+};
+
+inline constexpr DirectionTable direction_table{};
+
+// The plain loop over D[begin, end), carrying the length m of an unfinished
+// run in and out
+inline void build_strokes_scalar(const int *L, const char *D, size_t begin,
+                                 size_t end, size_t n, long long &x,
+                                 long long &y, long long &m,
+                                 std::vector<Interval> &vstrokes,
+                                 std::vector<Interval> &hstrokes) {
+  for (size_t i = begin; i < end; i++) {
+    m += L[i];
+    if (i + 1 < n && D[i + 1] == D[i])
+      continue;
+
+    switch (D[i]) {
+    case 'U':
+      vstrokes.emplace_back(x, y, y + m);
+      y += m;
+      break;
+    case 'D':
+      vstrokes.emplace_back(x, y - m, y);
+      y -= m;
+      break;
+    case 'L':
+      hstrokes.emplace_back(y, x - m, x);
+      x -= m;
+      break;
+    case 'R':
+      hstrokes.emplace_back(y, x, x + m);
+      x += m;
+      break;
+    }
+    m = 0;
+  }
+}
+
+// Collapses runs of the same direction into one stroke, as every variant does.
+//
+// Run ends come from the RunEndKernel in blocks, so long runs are skipped 32
+// characters at a time. Each run then writes its stroke to both block
+// buffers and only advances the one its direction belongs to, which leaves
+// no branch on the direction.
+//
+// A block that turns at nearly every character in a short repeating pattern,
+// as combs, spirals, staircases and retraces do, goes through the plain loop
+// instead: its branches predict perfectly there and it writes each stroke
+// once, which makes it about twice as fast. The TurnProfile that decides
+// costs a few compares per 32 characters.
+//
+// This form takes L/D[0, n) starting from (x, y), treating position n as the
+// end of the drawing, so the last run always ends there.
+inline void build_strokes_range(const int *L, const char *D, size_t n,
+                                long long x, long long y,
+                                std::vector<Interval> &vstrokes,
+                                std::vector<Interval> &hstrokes) {
+  constexpr size_t block = 512;
+  uint32_t ends[block];
+  long long sums[block + 1]; // sums[k] = L[begin] + ... + L[begin + k - 1]
+  Interval vbuf[block], hbuf[block];
+  const RunEndKernel kernel = run_end_kernel();
+  const TurnProfileKernel profile_of = turn_profile_kernel();
+
+  long long run_start = 0; // -(length of the current run before this block)
+  for (size_t begin = 0; begin < n; begin += block) {
+    const size_t end = std::min(n, begin + block);
+    const TurnProfile profile = profile_of(D, begin, end, n);
+    if (profile.run_ends * 8 >= (end - begin) * 7 &&
+        profile.repeats * 8 >= (end - begin) * 7) {
+      long long m = -run_start;
+      build_strokes_scalar(L, D, begin, end, n, x, y, m, vstrokes, hstrokes);
+      run_start = -m;
+      continue;
+    }
+    const size_t runs = kernel(D, begin, end, n, ends);
+    sums[0] = 0;
+    for (size_t k = 0; k < end - begin; k++)
+      sums[k + 1] = sums[k] + L[begin + k];
+
+    size_t nv = 0, nh = 0;
+    for (size_t r = 0; r < runs; r++) {
+      const size_t last = ends[r];
+      const long long m = sums[last + 1] - run_start;
+      const DirectionStep step =
+          direction_table.steps[(unsigned char)D[begin + last]];
+      // Masking the negative part of the move keeps min/max from turning
+      // back into branches
+      const long long dx = step.dx * m, dy = step.dy * m;
+      const long long back_x = dx & (dx >> 63), back_y = dy & (dy >> 63);
+      vbuf[nv] = Interval(x, y + back_y, y + dy - back_y);
+      hbuf[nh] = Interval(y, x + back_x, x + dx - back_x);
+      nv += step.vertical;
+      nh += step.horizontal;
+      x += dx;
+      y += dy;
+      run_start = sums[last + 1];
+    }
+    // Carry the unfinished run into the next block
+    run_start -= sums[end - begin];
+    vstrokes.insert(vstrokes.end(), vbuf, vbuf + nv);
+    hstrokes.insert(hstrokes.end(), hbuf, hbuf + nh);
+  }
+}
+
+inline void build_strokes(int N, const std::vector<int> &L,
+                          const std::string &D,
+                          std::vector<Interval> &vstrokes,
+                          std::vector<Interval> &hstrokes) {
+  build_strokes_range(L.data(), D.data(), N, 0, 0, vstrokes, hstrokes);
+}
+
+// The same run-collapsing for callers that see one step at a time (streamed
+// or decoded input). Call finish() after the last step.
+struct StrokeBuilder {
+  std::vector<Interval> &vstrokes, &hstrokes;
+  long long x = 0, y = 0, m = 0;
+  char dir = 0;
+
+  StrokeBuilder(std::vector<Interval> &vstrokes_,
+                std::vector<Interval> &hstrokes_)
+      : vstrokes(vstrokes_), hstrokes(hstrokes_) {}
+
+  void step(char d, long long len) {
+    if (d != dir)
+      flush();
+    dir = d;
+    m += len;
+  }
+
+  void finish() {
+    flush();
+    dir = 0;
+  }
+
+private:
+  void flush() {
+    switch (dir) {
+    case 'U':
+      vstrokes.emplace_back(x, y, y + m);
+      y += m;
+      break;
+    case 'D':
+      vstrokes.emplace_back(x, y - m, y);
+      y -= m;
+      break;
+    case 'L':
+      hstrokes.emplace_back(y, x - m, x);
+      x -= m;
+      break;
+    case 'R':
+      hstrokes.emplace_back(y, x, x + m);
+      x += m;
+      break;
+    }
+    m = 0;
+  }
+};
+
+struct Fenwick {
+  std::vector<int> tree;
+
+  void reset(size_t n) { tree.assign(n + 1, 0); }
+
+  // Turns tree[i + 1], set to the value at i for every i, into the tree.
+  // O(n), against O(n log n) for n calls to add.
+  void build() {
+    for (size_t i = 1; i < tree.size(); i++) {
+      const size_t parent = i + (i & (~i + 1));
+      if (parent < tree.size())
+        tree[parent] += tree[i];
+    }
+  }
+
+  void add(size_t i, int delta) {
+    for (i++; i < tree.size(); i += i & (~i + 1))
+      tree[i] += delta;
+  }
+
+  // Sum of [0, i)
+  long long prefix(size_t i) const {
+    long long sum = 0;
+    for (; i > 0; i -= i & (~i + 1))
+      sum += tree[i];
+    return sum;
+  }
+};
+
+// Buffers used by count_crossings_sweep, kept by callers that count many
+// drawings so the sweep doesn't allocate once they have grown
+struct SweepScratch {
+  std::vector<long long> xs;
+  std::vector<std::pair<long long, int>> starts, ends, events;
+  Fenwick active;
+};
+
+// Counts points that lie strictly inside one horizontal and one vertical
+// line. Both inputs must be merged (sorted by (a, s), no two lines on the same
+// anchor overlapping or touching), which is what merge_intervals produces.
+//
+// Sweeps y upwards. A vertical line is active on the open range (s, e), and
+// each horizontal line asks the Fenwick tree how many active anchors lie in
+// (s, e). O((V + H) log V).
+inline long long count_crossings_sweep(const std::vector<Interval> &hlines,
+                                       const std::vector<Interval> &vlines,
+                                       SweepScratch &sc) {
+  if (hlines.empty() || vlines.empty())
+    return 0;
+
+  std::vector<long long> &xs = sc.xs;
+  xs.clear();
+  for (const Interval &vline : vlines)
+    xs.push_back(vline.a);
+  // vlines are sorted by anchor, so xs already is
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+  // (key, rank of anchor) for activation at s and deactivation at e
+  std::vector<std::pair<long long, int>> &starts = sc.starts, &ends = sc.ends;
+  starts.clear();
+  ends.clear();
+  for (const Interval &vline : vlines) {
+    // A zero-length line has nothing strictly inside it, and its end would
+    // be seen before its start
+    if (vline.s == vline.e)
+      continue;
+    int rank = std::lower_bound(xs.begin(), xs.end(), vline.a) - xs.begin();
+    starts.emplace_back(vline.s, rank);
+    ends.emplace_back(vline.e, rank);
+  }
+  // Ties between equal keys don't matter, so sort on the key alone
+  auto key = [](const std::pair<long long, int> &event) {
+    return event.first;
+  };
+  radix_sort(starts, sc.events, key);
+  radix_sort(ends, sc.events, key);
+
+  Fenwick &active = sc.active;
+  active.reset(xs.size());
+  long long nplus = 0;
+  size_t si = 0, ei = 0;
+  for (const Interval &hline : hlines) {
+    while (si < starts.size() && starts[si].first < hline.a)
+      active.add(starts[si++].second, 1);
+    while (ei < ends.size() && ends[ei].first <= hline.a)
+      active.add(ends[ei++].second, -1);
+
+    size_t lo = std::upper_bound(xs.begin(), xs.end(), hline.s) - xs.begin();
+    size_t hi = std::lower_bound(xs.begin(), xs.end(), hline.e) - xs.begin();
+    if (lo < hi)
+      nplus += active.prefix(hi) - active.prefix(lo);
+  }
+  return nplus;
+}
+
+inline long long count_crossings_sweep(const std::vector<Interval> &hlines,
+                                       const std::vector<Interval> &vlines) {
+  SweepScratch sc;
+  sc.xs.reserve(vlines.size());
+  sc.starts.reserve(vlines.size());
+  sc.ends.reserve(vlines.size());
+  return count_crossings_sweep(hlines, vlines, sc);
+}
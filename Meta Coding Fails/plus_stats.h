@@ -0,0 +1,152 @@
+#pragma once
+
+// Opt-in per-call counters for the plus sign pipelines. Build with
+// -DPLUS_STATS and every instrumented getPlusSignCount writes one JSON line
+// to stderr:
+//
+//   {"variant":"sweep_fenwick","build_ns":...,"sort_ns":...,"merge_ns":...,
+//    "count_ns":...,"total_ns":...,"vstrokes":...,"hstrokes":...,
+//    "vlines":...,"hlines":...,"candidates":...,"crossings":...,
+//    "allocs":...,"alloc_bytes":...}
+//
+// candidates is the number of (vline, hline) pairs a window scan looked at;
+// the sweep doesn't look at pairs and leaves it 0. allocs/alloc_bytes count
+// operator new calls made by the calling thread during the call.
+//
+// Without PLUS_STATS every macro expands to nothing.
+//
+//   PLUS_STATS_BEGIN()          reset the counters at the start of a call
+//   PLUS_LAP(phase)             add the time since the last lap (or BEGIN)
+//                               to <phase>_ns: build, sort, merge or count
+//   PLUS_STAT_ADD(field, n)     add n to a counter
+//   PLUS_STATS_END("variant")   write the JSON line
+
+#ifdef PLUS_STATS
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+struct PlusStats {
+  uint64_t build_ns, sort_ns, merge_ns, count_ns;
+  uint64_t vstrokes, hstrokes, vlines, hlines;
+  uint64_t candidates, crossings;
+  uint64_t allocs, alloc_bytes;
+};
+
+inline thread_local PlusStats plus_stats;
+inline thread_local std::chrono::steady_clock::time_point plus_stats_start,
+    plus_stats_lap;
+inline thread_local uint64_t plus_thread_allocs, plus_thread_alloc_bytes;
+
+// Counting replacements for the global allocator. Every program in this
+// directory is a single translation unit, so defining them here is fine.
+// Allocation and release go through the two helpers below. Once GCC has
+// inlined malloc into operator new and free into operator delete, it warns
+// that the pair doesn't match (-Wmismatched-new-delete), so they stay out of
+// line.
+__attribute__((noinline)) inline void *plus_stats_malloc(size_t size,
+                                                         size_t align) {
+  plus_thread_allocs++;
+  plus_thread_alloc_bytes += size;
+  void *p = nullptr;
+  if (align <= alignof(std::max_align_t))
+    p = std::malloc(size ? size : 1);
+  else if (posix_memalign(&p, align, size ? size : 1) != 0)
+    p = nullptr;
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+__attribute__((noinline)) inline void plus_stats_free(void *p) noexcept {
+  std::free(p);
+}
+
+void *operator new(size_t size) { return plus_stats_malloc(size, 0); }
+void *operator new[](size_t size) { return plus_stats_malloc(size, 0); }
+
+void operator delete(void *p) noexcept { plus_stats_free(p); }
+void operator delete[](void *p) noexcept { plus_stats_free(p); }
+void operator delete(void *p, size_t) noexcept { plus_stats_free(p); }
+void operator delete[](void *p, size_t) noexcept { plus_stats_free(p); }
+
+// The over-aligned forms, which std::pmr::new_delete_resource always uses
+void *operator new(size_t size, std::align_val_t align) {
+  return plus_stats_malloc(size, std::max(sizeof(void *), (size_t)align));
+}
+void *operator new[](size_t size, std::align_val_t align) {
+  return plus_stats_malloc(size, std::max(sizeof(void *), (size_t)align));
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+  plus_stats_free(p);
+}
+void operator delete[](void *p, std::align_val_t) noexcept {
+  plus_stats_free(p);
+}
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+  plus_stats_free(p);
+}
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+  plus_stats_free(p);
+}
+
+inline uint64_t plus_stats_elapsed(std::chrono::steady_clock::time_point from) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - from)
+      .count();
+}
+
+inline void plus_stats_add_lap(uint64_t &ns) {
+  auto now = std::chrono::steady_clock::now();
+  ns += std::chrono::duration_cast<std::chrono::nanoseconds>(now -
+                                                             plus_stats_lap)
+            .count();
+  plus_stats_lap = now;
+}
+
+inline void plus_stats_begin() {
+  plus_stats = PlusStats();
+  plus_stats.allocs = plus_thread_allocs;
+  plus_stats.alloc_bytes = plus_thread_alloc_bytes;
+  plus_stats_start = plus_stats_lap = std::chrono::steady_clock::now();
+}
+
+inline void plus_stats_end(const char *variant) {
+  const PlusStats &s = plus_stats;
+  uint64_t total_ns = plus_stats_elapsed(plus_stats_start);
+  std::fprintf(
+      stderr,
+      "{\"variant\":\"%s\",\"build_ns\":%llu,\"sort_ns\":%llu,"
+      "\"merge_ns\":%llu,\"count_ns\":%llu,\"total_ns\":%llu,"
+      "\"vstrokes\":%llu,\"hstrokes\":%llu,\"vlines\":%llu,\"hlines\":%llu,"
+      "\"candidates\":%llu,\"crossings\":%llu,\"allocs\":%llu,"
+      "\"alloc_bytes\":%llu}\n",
+      variant, (unsigned long long)s.build_ns, (unsigned long long)s.sort_ns,
+      (unsigned long long)s.merge_ns, (unsigned long long)s.count_ns,
+      (unsigned long long)total_ns, (unsigned long long)s.vstrokes,
+      (unsigned long long)s.hstrokes, (unsigned long long)s.vlines,
+      (unsigned long long)s.hlines, (unsigned long long)s.candidates,
+      (unsigned long long)s.crossings,
+      (unsigned long long)(plus_thread_allocs - s.allocs),
+      (unsigned long long)(plus_thread_alloc_bytes - s.alloc_bytes));
+}
+
+#define PLUS_STATS_BEGIN() plus_stats_begin()
+#define PLUS_LAP(phase) plus_stats_add_lap(plus_stats.phase##_ns)
+#define PLUS_STAT_ADD(field, n) (plus_stats.field += (n))
+#define PLUS_STATS_END(variant) plus_stats_end(variant)
+
+#else
+
+#define PLUS_STATS_BEGIN() ((void)0)
+#define PLUS_LAP(phase) ((void)0)
+#define PLUS_STAT_ADD(field, n) ((void)0)
+#define PLUS_STATS_END(variant) ((void)0)
+
+#endif
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "plus_sign.h"
+
+// Lists plus signs one at a time, in (x, y) order, without ever holding more
+// than the lines. All memory is taken when the stream is built; next(), read()
+// and iteration don't allocate.
+//
+//   PlusStream stream(hlines, vlines);
+//   for (PlusPoint p : stream) ...
+//
+//   PlusPoint buffer[4096];
+//   stream.for_each_chunk(buffer, 4096, [&](const PlusPoint *p, size_t n) {
+//     fwrite(p, sizeof(PlusPoint), n, out);
+//   });
+//
+// The lines must be merged (merge_intervals) and outlive the stream. It sweeps
+// the vertical lines left to right; the horizontal lines strictly around the
+// current x sit in a bitset over their heights, and the plus signs on a
+// vertical line are the set bits strictly between its ends.
+
+struct PlusPoint {
+  long long x, y;
+};
+
+// Bitset with a summary level per 64 words, so the next set bit is found in
+// O(log_64 n) however sparse the set is
+class SuccessorBits {
+public:
+  static constexpr size_t npos = ~size_t(0);
+
+  // Clears to n bits; keeps the storage when n doesn't grow
+  void reset(size_t n) {
+    size_t k = 0;
+    do {
+      n = (n + 63) / 64;
+      if (k == levels.size())
+        levels.emplace_back();
+      levels[k++].assign(n, 0);
+    } while (n > 1);
+    levels.resize(k);
+  }
+
+  void set(size_t i) {
+    for (std::vector<uint64_t> &words : levels) {
+      uint64_t &word = words[i / 64];
+      const bool was_empty = word == 0;
+      word |= 1ULL << (i % 64);
+      if (!was_empty)
+        return;
+      i /= 64;
+    }
+  }
+
+  void clear(size_t i) {
+    for (std::vector<uint64_t> &words : levels) {
+      uint64_t &word = words[i / 64];
+      word &= ~(1ULL << (i % 64));
+      if (word != 0)
+        return;
+      i /= 64;
+    }
+  }
+
+  // First set bit at or after i, or npos
+  size_t next(size_t i) const {
+    for (size_t k = 0; k < levels.size(); k++) {
+      const std::vector<uint64_t> &words = levels[k];
+      if (i / 64 >= words.size())
+        return npos;
+      uint64_t word = words[i / 64] & (~0ULL << (i % 64));
+      if (word != 0) {
+        i = i / 64 * 64 + __builtin_ctzll(word);
+        while (k-- > 0)
+          i = i * 64 + __builtin_ctzll(levels[k][i]);
+        return i;
+      }
+      i = i / 64 + 1;
+    }
+    return npos;
+  }
+
+private:
+  std::vector<std::vector<uint64_t>> levels;
+};
+
+class PlusStream {
+public:
+  PlusStream(const std::vector<Interval> &hlines,
+             const std::vector<Interval> &vlines)
+      : hlines(hlines), vlines(vlines) {
+    for (const Interval &h : hlines)
+      heights.push_back(h.a);
+    std::sort(heights.begin(), heights.end());
+    heights.erase(std::unique(heights.begin(), heights.end()), heights.end());
+    height_of.resize(hlines.size());
+    for (size_t i = 0; i < hlines.size(); i++)
+      height_of[i] = std::lower_bound(heights.begin(), heights.end(),
+                                      hlines[i].a) -
+                     heights.begin();
+
+    // A horizontal line is around x for s < x < e: it goes in at s + 1 and
+    // out at e. Ties put the entry first, so a line with e = s + 1 is never
+    // left in; a zero-length line would leave before it enters, so it is
+    // skipped.
+    for (size_t i = 0; i < hlines.size(); i++) {
+      if (hlines[i].s == hlines[i].e)
+        continue;
+      changes.push_back({hlines[i].s + 1, (int)i, true});
+      changes.push_back({hlines[i].e, (int)i, false});
+    }
+    std::sort(changes.begin(), changes.end(),
+              [](const Change &l, const Change &r) {
+                return l.x != r.x ? l.x < r.x : l.enter > r.enter;
+              });
+    rewind();
+  }
+
+  // Back to the first plus sign
+  void rewind() {
+    active.reset(heights.size());
+    next_change = 0;
+    line = 0;
+    cursor = end_bit = 0;
+  }
+
+  bool next(PlusPoint &point) {
+    for (;;) {
+      if (cursor < end_bit) {
+        size_t bit = active.next(cursor);
+        if (bit < end_bit) {
+          cursor = bit + 1;
+          point = {vlines[line - 1].a, heights[bit]};
+          return true;
+        }
+      }
+      if (line == vlines.size())
+        return false;
+      open(vlines[line++]);
+    }
+  }
+
+  // Up to capacity plus signs into out; fewer only at the end
+  size_t read(PlusPoint *out, size_t capacity) {
+    size_t n = 0;
+    while (n < capacity && next(out[n]))
+      n++;
+    return n;
+  }
+
+  // Calls sink(points, n) with consecutive chunks of at most capacity plus
+  // signs, all written to buffer
+  template <class Sink>
+  void for_each_chunk(PlusPoint *buffer, size_t capacity, Sink sink) {
+    for (size_t n; (n = read(buffer, capacity)) > 0;)
+      sink(static_cast<const PlusPoint *>(buffer), n);
+  }
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = PlusPoint;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const PlusPoint *;
+    using reference = const PlusPoint &;
+
+    iterator() = default;
+    explicit iterator(PlusStream *stream) : stream(stream) { ++*this; }
+
+    reference operator*() const { return point; }
+    pointer operator->() const { return &point; }
+    iterator &operator++() {
+      if (!stream->next(point))
+        stream = nullptr;
+      return *this;
+    }
+    bool operator==(const iterator &other) const {
+      return stream == other.stream;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+
+  private:
+    PlusStream *stream = nullptr;
+    PlusPoint point{};
+  };
+
+  // Iterating rewinds first, so each loop sees every plus sign
+  iterator begin() {
+    rewind();
+    return iterator(this);
+  }
+  iterator end() { return iterator(); }
+
+private:
+  struct Change {
+    long long x;
+    int line;
+    bool enter;
+  };
+
+  const std::vector<Interval> &hlines;
+  const std::vector<Interval> &vlines;
+  std::vector<long long> heights;
+  std::vector<size_t> height_of;
+  std::vector<Change> changes;
+
+  SuccessorBits active;
+  size_t next_change = 0;
+  size_t line = 0;             // vertical lines opened so far
+  size_t cursor = 0, end_bit = 0; // heights left to visit on the last one
+
+  // Moves the sweep to v's x and limits the scan to heights strictly inside
+  // it
+  void open(const Interval &v) {
+    for (; next_change < changes.size() && changes[next_change].x <= v.a;
+         next_change++) {
+      const Change &change = changes[next_change];
+      if (change.enter)
+        active.set(height_of[change.line]);
+      else
+        active.clear(height_of[change.line]);
+    }
+    cursor = std::upper_bound(heights.begin(), heights.end(), v.s) -
+             heights.begin();
+    end_bit = std::lower_bound(heights.begin(), heights.end(), v.e) -
+              heights.begin();
+  }
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LSD radix sort on signed 64-bit keys, 11 bits per pass. Keys are given
+// most significant first as callables returning long long.
+//
+// Each key is biased by its minimum before splitting it into digits. That
+// keeps signed order (like flipping the sign bit would) but also means a
+// drawing whose coordinates straddle zero doesn't have every high byte flip
+// between 0x7f.. and 0x80... Digits above the key range are never looked at,
+// and a pass is skipped when all items share that digit. Stable, O(n) per
+// executed pass.
+//
+// `scratch` is resized to items.size() and may be swapped with `items`, so
+// pass the same scratch vector back in to reuse its allocation.
+
+constexpr int radix_bits = 11;
+constexpr int radix_digits = (64 + radix_bits - 1) / radix_bits;
+constexpr size_t radix_buckets = size_t(1) << radix_bits;
+constexpr uint64_t radix_mask = radix_buckets - 1;
+constexpr size_t radix_small = 64;
+
+template <class T> inline bool radix_less(const T &, const T &) {
+  return false;
+}
+
+template <class T, class Key, class... Rest>
+inline bool radix_less(const T &lhs, const T &rhs, Key key, Rest... rest) {
+  long long l = key(lhs), r = key(rhs);
+  if (l != r)
+    return l < r;
+  return radix_less(lhs, rhs, rest...);
+}
+
+template <class T, class Key>
+inline void radix_sort_by_key(std::vector<T> &items, std::vector<T> &scratch,
+                              Key key) {
+  const size_t n = items.size();
+  long long lo = key(items[0]), hi = lo;
+  for (const T &item : items) {
+    long long k = key(item);
+    lo = std::min(lo, k);
+    hi = std::max(hi, k);
+  }
+  const uint64_t bias = (uint64_t)lo;
+  const uint64_t range = (uint64_t)hi - bias;
+  int digits = 0;
+  while (digits < radix_digits && (range >> (radix_bits * digits)) != 0)
+    digits++;
+  if (digits == 0)
+    return;
+
+  static thread_local size_t counts[radix_digits][radix_buckets];
+  std::fill(&counts[0][0], &counts[0][0] + digits * radix_buckets, 0);
+  for (const T &item : items) {
+    uint64_t bits = (uint64_t)key(item) - bias;
+    for (int d = 0; d < digits; d++)
+      counts[d][(bits >> (radix_bits * d)) & radix_mask]++;
+  }
+
+  scratch.resize(n);
+  const uint64_t first = (uint64_t)key(items[0]) - bias;
+  for (int d = 0; d < digits; d++) {
+    const int shift = radix_bits * d;
+    size_t *count = counts[d];
+    if (count[(first >> shift) & radix_mask] == n)
+      continue;
+
+    size_t offset = 0;
+    for (size_t b = 0; b < radix_buckets; b++) {
+      size_t c = count[b];
+      count[b] = offset;
+      offset += c;
+    }
+    for (const T &item : items)
+      scratch[count[(((uint64_t)key(item) - bias) >> shift) & radix_mask]++] =
+          item;
+    items.swap(scratch);
+  }
+}
+
+template <class T, class Key>
+inline void radix_sort_keys(std::vector<T> &items, std::vector<T> &scratch,
+                            Key key) {
+  radix_sort_by_key(items, scratch, key);
+}
+
+// Least significant key first; each pass is stable
+template <class T, class Key, class... Rest>
+inline void radix_sort_keys(std::vector<T> &items, std::vector<T> &scratch,
+                            Key key, Rest... rest) {
+  radix_sort_keys(items, scratch, rest...);
+  radix_sort_by_key(items, scratch, key);
+}
+
+template <class T, class... Keys>
+inline void radix_sort(std::vector<T> &items, std::vector<T> &scratch,
+                       Keys... keys) {
+  if (items.size() < radix_small) {
+    // Insertion sort: stable, and unlike std::stable_sort it never
+    // allocates, which matters to callers reusing their buffers
+    for (size_t i = 1; i < items.size(); i++) {
+      T item = items[i];
+      size_t j = i;
+      for (; j > 0 && radix_less(item, items[j - 1], keys...); j--)
+        items[j] = items[j - 1];
+      items[j] = item;
+    }
+    return;
+  }
+  radix_sort_keys(items, scratch, keys...);
+}
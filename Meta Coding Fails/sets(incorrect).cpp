@@ -1,9 +1,13 @@
 #include <iostream>
 #include <iterator>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "arena_resource.h"
+#include "plus_stats.h"
+
 using namespace std;
 
 struct Interval {
@@ -42,11 +46,20 @@ struct CompareByStartAnchor {
   }
 };
 
+// Set for the _heap copies engines.h includes; see plus_node_resource
+#ifdef PLUS_HEAP_NODES
+constexpr bool heap_nodes = true;
+#else
+constexpr bool heap_nodes = false;
+#endif
+
 class IntervalSet {
 private:
-  set<Interval, CompareByAnchorStart> intervals;
+  pmr::set<Interval, CompareByAnchorStart> intervals;
 
 public:
+  explicit IntervalSet(pmr::memory_resource *nodes) : intervals(nodes) {}
+
   void insert(Interval newInterval) {
     auto it = intervals.lower_bound(newInterval);
 
@@ -69,16 +82,19 @@ public:
     intervals.insert(newInterval);
   }
 
-  const set<Interval, CompareByAnchorStart> &getIntervals() const {
+  const pmr::set<Interval, CompareByAnchorStart> &getIntervals() const {
     return intervals;
   }
 };
 
 class IntervalSetByStart {
 private:
-  set<Interval, CompareByStartAnchor> intervals;
+  pmr::set<Interval, CompareByStartAnchor> intervals;
 
 public:
+  explicit IntervalSetByStart(pmr::memory_resource *nodes)
+      : intervals(nodes) {}
+
   void insert(Interval newInterval) {
     auto it = intervals.lower_bound(newInterval);
 
@@ -101,15 +117,17 @@ public:
     intervals.insert(newInterval);
   }
 
-  const set<Interval, CompareByStartAnchor> &getIntervals() const {
+  const pmr::set<Interval, CompareByStartAnchor> &getIntervals() const {
     return intervals;
   }
 };
 
 long long getPlusSignCount(int N, vector<int> L, string D) {
+  PLUS_STATS_BEGIN();
+  pmr::memory_resource *nodes = plus_node_resource(heap_nodes);
   long long x = 0, y = 0, m = 0;
-  IntervalSet hlines;
-  IntervalSetByStart vlines;
+  IntervalSet hlines(nodes);
+  IntervalSetByStart vlines(nodes);
 
   for (int i = 0; i < N; i++) {
     m += L[i];
@@ -136,6 +154,9 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
     }
     m = 0;
   }
+  PLUS_LAP(merge);
+  PLUS_STAT_ADD(vlines, vlines.getIntervals().size());
+  PLUS_STAT_ADD(hlines, hlines.getIntervals().size());
 
   long long nplus = 0;
   auto hline_it = hlines.getIntervals().begin();
@@ -146,12 +167,16 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
 
     auto current_h = hline_it;
     while (current_h != hlines.getIntervals().end() && current_h->a < vline.e) {
+      PLUS_STAT_ADD(candidates, 1);
       if (current_h->s < vline.a && vline.a < current_h->e) {
         nplus++;
       }
       current_h++;
     }
   }
+  PLUS_LAP(count);
+  PLUS_STAT_ADD(crossings, nplus);
+  PLUS_STATS_END(heap_nodes ? "sets_heap" : "sets");
   return nplus;
 }
 
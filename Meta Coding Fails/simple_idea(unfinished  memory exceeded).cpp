@@ -1,10 +1,10 @@
 #include <iostream>
 #include <iterator>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include "flat_hash.h"
+
 using namespace std;
 
 // Custom struct for coordinates
@@ -17,51 +17,49 @@ struct Coord {
 };
 
 // Hash function for Coord
-namespace std {
-template <> struct hash<Coord> {
+struct CoordHash {
   size_t operator()(const Coord &coord) const {
-    return hash<long long>()(coord.x) ^ (hash<long long>()(coord.y) << 1);
+    return hash_combine(hash_mix(coord.x), coord.y);
   }
 };
-} // namespace std
 
+// The cell maps only ever stored true, so they are sets
 long long getPlusSignCount(int N, vector<int> L, string D) {
-  long long nplus, x, y, j = 0;
-  unordered_map<Coord, bool> vertical_stroke_coords;
-  unordered_map<Coord, bool> horizontal_stroke_coords;
-  unordered_set<Coord> plus_sign_coords;
+  long long nplus = 0, x = 0, y = 0, j = 0;
+  FlatHashSet<Coord, CoordHash> vertical_stroke_coords;
+  FlatHashSet<Coord, CoordHash> horizontal_stroke_coords;
+  FlatHashSet<Coord, CoordHash> plus_sign_coords;
 
   char prev_dir = ' ';
   for (int i = 0; i < N; i++) {
     switch (D[i]) {
     case 'U':
       if (prev_dir == 'L' || prev_dir == 'R')
-        vertical_stroke_coords[Coord{x, y}] = true;
+        vertical_stroke_coords.insert(Coord{x, y});
       for (j = 0; j < L[i]; j++)
-        vertical_stroke_coords[Coord{x, ++y}] = true;
+        vertical_stroke_coords.insert(Coord{x, ++y});
       break;
     case 'D':
       if (prev_dir == 'L' || prev_dir == 'R')
-        vertical_stroke_coords[Coord{x, y}] = true;
+        vertical_stroke_coords.insert(Coord{x, y});
       for (j = 0; j < L[i]; j++)
-        vertical_stroke_coords[Coord{x, --y}] = true;
+        vertical_stroke_coords.insert(Coord{x, --y});
       break;
     case 'L':
       if (prev_dir == 'U' || prev_dir == 'D')
-        horizontal_stroke_coords[Coord{x, y}] = true;
+        horizontal_stroke_coords.insert(Coord{x, y});
       for (j = 0; j < L[i]; j++)
-        horizontal_stroke_coords[Coord{--x, y}] = true;
+        horizontal_stroke_coords.insert(Coord{--x, y});
       break;
     case 'R':
       if (prev_dir == 'U' || prev_dir == 'D')
-        horizontal_stroke_coords[Coord{x, y}] = true;
+        horizontal_stroke_coords.insert(Coord{x, y});
       for (j = 0; j < L[i]; j++)
-        horizontal_stroke_coords[Coord{++x, y}] = true;
+        horizontal_stroke_coords.insert(Coord{++x, y});
       break;
     }
     prev_dir = D[i];
   }
-  long long nplus;
   return nplus;
 }
 
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "interval_soa.h"
+#include "plus_sign.h"
+#include "plus_stats.h"
+
+using namespace std;
+
+// Same window scan as vector(slow).cpp, but hlines live in an IntervalSoA,
+// the window end is found by binary search on the anchors, and the
+// s < x < e test runs through a vector kernel chosen at runtime.
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  PLUS_STATS_BEGIN();
+  vector<Interval> vstrokes, hstrokes, vlines, hlines;
+  vstrokes.reserve(N);
+  hstrokes.reserve(N);
+  build_strokes(N, L, D, vstrokes, hstrokes);
+  PLUS_LAP(build);
+  PLUS_STAT_ADD(vstrokes, vstrokes.size());
+  PLUS_STAT_ADD(hstrokes, hstrokes.size());
+
+  vector<Interval> scratch;
+  sort_by_anchor_start(hstrokes, scratch);
+  PLUS_LAP(sort);
+  merge_intervals(hstrokes, hlines);
+  PLUS_LAP(merge);
+  sort_by_anchor_start(vstrokes, scratch);
+  PLUS_LAP(sort);
+  merge_intervals(vstrokes, vlines);
+  PLUS_LAP(merge);
+  sort_by_start_anchor(vlines, scratch);
+  PLUS_LAP(sort);
+  PLUS_STAT_ADD(vlines, vlines.size());
+  PLUS_STAT_ADD(hlines, hlines.size());
+
+  IntervalSoA h;
+  h.assign(hlines);
+  const CrossingKernel kernel = crossing_kernel();
+
+  long long nplus = 0;
+  size_t h_idx = 0;
+  const size_t h_size = h.size();
+  for (const Interval &vline : vlines) {
+    // Advance to first potentially intersecting horizontal line
+    while (h_idx < h_size && h.a[h_idx] <= vline.s)
+      h_idx++;
+
+    // Horizontal lines in [h_idx, h_end) have vline.s < a < vline.e
+    size_t h_end = lower_bound(h.a.begin() + h_idx, h.a.end(), vline.e) -
+                   h.a.begin();
+    nplus += kernel(h.s.data() + h_idx, h.e.data() + h_idx, h_end - h_idx,
+                    vline.a);
+    PLUS_STAT_ADD(candidates, h_end - h_idx);
+  }
+  PLUS_LAP(count);
+  PLUS_STAT_ADD(crossings, nplus);
+  PLUS_STATS_END("soa_avx2");
+  return nplus;
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
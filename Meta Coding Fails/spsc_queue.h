@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded ring buffer for exactly one producer thread and one consumer
+// thread, without locks. try_push fails when the ring is full and try_pop
+// when it is empty; callers decide whether to spin, yield or do something
+// else.
+//
+// Each side keeps a cached copy of the other side's index and only reloads
+// it when the ring looks full (or empty), so in steady state a push or pop
+// touches one shared cache line. The two indices sit on separate lines.
+template <class T> class SpscQueue {
+public:
+  explicit SpscQueue(size_t capacity = 1) { reset(capacity); }
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  // Empties the ring and makes room for at least capacity items. Only while
+  // neither side is using it.
+  void reset(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+    slots.assign(size, T());
+    mask = size - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    tail_cache = head_cache = 0;
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+  // Producer only
+  bool try_push(const T &item) {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head_cache > mask) {
+      head_cache = head.load(std::memory_order_acquire);
+      if (t - head_cache > mask)
+        return false;
+    }
+    slots[t & mask] = item;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  bool try_pop(T &item) {
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail_cache) {
+      tail_cache = tail.load(std::memory_order_acquire);
+      if (h == tail_cache)
+        return false;
+    }
+    item = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T> slots;
+  size_t mask = 0;
+
+  // Consumer side
+  alignas(64) std::atomic<size_t> head{0};
+  size_t tail_cache = 0;
+
+  // Producer side
+  alignas(64) std::atomic<size_t> tail{0};
+  size_t head_cache = 0;
+};
@@ -0,0 +1,114 @@
+// Lists plus signs with PlusStream (plus_stream.h).
+//
+//   g++ -std=c++17 -O2 -I. -o stream_plus stream_plus.cpp
+//   ./stream_plus [strokes] [output file]
+//
+// Runs the usual three cases and one with a zero-length line by counting
+// the stream, then streams a large drawing in chunks, to the output file as
+// raw (x, y) pairs of 64-bit integers when one is given, and checks the
+// order and the total.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "plus_sign.h"
+#include "plus_stream.h"
+
+using namespace std;
+
+void build_lines(int N, const vector<int> &L, const string &D,
+                 vector<Interval> &hlines, vector<Interval> &vlines) {
+  vector<Interval> vstrokes, hstrokes, scratch;
+  build_strokes(N, L, D, vstrokes, hstrokes);
+  sort_by_anchor_start(hstrokes, scratch);
+  merge_intervals(hstrokes, hlines);
+  sort_by_anchor_start(vstrokes, scratch);
+  merge_intervals(vstrokes, vlines);
+}
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  vector<Interval> hlines, vlines;
+  build_lines(N, L, D, hlines, vlines);
+  long long nplus = 0;
+  for (PlusPoint p : PlusStream(hlines, vlines)) {
+    (void)p;
+    nplus++;
+  }
+  return nplus;
+}
+
+int main(int argc, char **argv) {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // A zero-length horizontal line on a vertical one
+  N = 4;
+  L = {2, 1, 1, 0};
+  D = "DLUL";
+  expected = 0;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  int strokes = argc > 1 ? atoi(argv[1]) : 1000000;
+  FILE *out = argc > 2 ? fopen(argv[2], "wb") : nullptr;
+  if (argc > 2 && !out) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  Drawing d = generate_drawing(Shape::random_walk, strokes, 1);
+  vector<Interval> hlines, vlines;
+  build_lines(d.N, d.L, d.D, hlines, vlines);
+
+  static PlusPoint buffer[1 << 14];
+  long long streamed = 0;
+  bool ordered = true;
+  PlusPoint last = {0, 0};
+  auto start = chrono::steady_clock::now();
+  PlusStream stream(hlines, vlines);
+  stream.for_each_chunk(buffer, 1 << 14, [&](const PlusPoint *p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      if (streamed + i > 0 && (p[i].x < last.x ||
+                               (p[i].x == last.x && p[i].y <= last.y)))
+        ordered = false;
+      last = p[i];
+    }
+    streamed += n;
+    if (out)
+      fwrite(p, sizeof(PlusPoint), n, out);
+  });
+  double ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+  if (out)
+    fclose(out);
+
+  long long counted = count_crossings_sweep(hlines, vlines);
+  cout << "Streamed " << streamed << " plus signs in " << ms << " ms, "
+       << (ordered ? "in" : "out of") << " (x, y) order; sweep count "
+       << counted << "\n";
+  return !ordered || streamed != counted;
+}
@@ -0,0 +1,164 @@
+// Counts plus signs straight from a drawing file in the text format of
+// drawing_gen.h, without loading L or D into memory.
+//
+//   g++ -std=c++17 -O2 -I. -o streaming_mmap streaming_mmap.cpp
+//   ./streaming_mmap drawing.txt [more.txt ...]
+//
+// With no arguments it runs the usual three cases through a temp file.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "drawing_gen.h"
+#include "mapped_file.h"
+#include "plus_sign.h"
+
+using namespace std;
+
+// How much input is walked between releasing the pages behind the cursors
+constexpr size_t STREAM_CHUNK = 16 << 20;
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static const char *skip_space(const char *p, const char *end) {
+  while (p < end && is_space(*p))
+    p++;
+  return p;
+}
+
+static const char *parse_int(const char *p, const char *end, long long &v) {
+  p = skip_space(p, end);
+  v = 0;
+  const char *start = p;
+  while (p < end && *p >= '0' && *p <= '9')
+    v = v * 10 + (*p++ - '0');
+  return p == start ? nullptr : p;
+}
+
+// Builds run-collapsed strokes from the file. The L cursor and the D cursor
+// walk the mapping in lockstep and the pages behind both are released every
+// STREAM_CHUNK bytes, so only the strokes stay resident.
+bool stream_strokes(const char *path, vector<Interval> &vstrokes,
+                    vector<Interval> &hstrokes) {
+  MappedFile file;
+  if (!file.open(path))
+    return false;
+  const char *begin = file.data, *end = file.data + file.size;
+
+  long long N;
+  const char *lp = parse_int(begin, end, N);
+  if (!lp || N < 0)
+    return false;
+
+  // D is the last line
+  const char *dend = end;
+  while (dend > lp && is_space(dend[-1]))
+    dend--;
+  const char *dp = dend;
+  while (dp > lp && !is_space(dp[-1]))
+    dp--;
+  if (N > 0 && dend - dp != N)
+    return false;
+
+  StrokeBuilder builder(vstrokes, hstrokes);
+  const char *l_released = lp, *d_released = dp;
+  for (long long i = 0; i < N; i++) {
+    long long len;
+    lp = parse_int(lp, dp, len);
+    if (!lp)
+      return false;
+    builder.step(dp[0], len);
+    dp++;
+
+    if (lp - l_released >= (ptrdiff_t)STREAM_CHUNK) {
+      file.release(l_released, lp);
+      file.release(d_released, dp);
+      l_released = lp;
+      d_released = dp;
+    }
+  }
+  builder.finish();
+  return true;
+}
+
+// Returns -1 if the file can't be read or isn't a drawing
+long long getPlusSignCountFromFile(const char *path) {
+  vector<Interval> vstrokes, hstrokes, vlines, hlines;
+  if (!stream_strokes(path, vstrokes, hstrokes))
+    return -1;
+
+  vector<Interval> scratch;
+  sort_by_anchor_start(hstrokes, scratch);
+  merge_intervals(hstrokes, hlines);
+  sort_by_anchor_start(vstrokes, scratch);
+  merge_intervals(vstrokes, vlines);
+  return count_crossings_sweep(hlines, vlines);
+}
+
+static long long count_through_file(int N, const vector<int> &L,
+                                    const string &D) {
+  char path[] = "/tmp/plus_drawing_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return -1;
+  close(fd);
+  Drawing d;
+  d.N = N;
+  d.L = L;
+  d.D = D;
+  {
+    ofstream out(path);
+    write_drawing(out, d);
+  }
+  long long result = getPlusSignCountFromFile(path);
+  unlink(path);
+  return result;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+      long long result = getPlusSignCountFromFile(argv[i]);
+      if (result < 0) {
+        cerr << argv[i] << ": not a readable drawing\n";
+        status = 1;
+        continue;
+      }
+      cout << argv[i] << ": " << result << "\n";
+    }
+    return status;
+  }
+
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = count_through_file(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = count_through_file(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = count_through_file(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "plus_sign.h"
+#include "plus_stats.h"
+
+using namespace std;
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  PLUS_STATS_BEGIN();
+  vector<Interval> vstrokes, hstrokes, vlines, hlines;
+  vstrokes.reserve(N);
+  hstrokes.reserve(N);
+  build_strokes(N, L, D, vstrokes, hstrokes);
+  PLUS_LAP(build);
+  PLUS_STAT_ADD(vstrokes, vstrokes.size());
+  PLUS_STAT_ADD(hstrokes, hstrokes.size());
+
+  // Radix sort and merge collinear strokes
+  vector<Interval> scratch;
+  sort_by_anchor_start(hstrokes, scratch);
+  PLUS_LAP(sort);
+  merge_intervals(hstrokes, hlines);
+  PLUS_LAP(merge);
+  sort_by_anchor_start(vstrokes, scratch);
+  PLUS_LAP(sort);
+  merge_intervals(vstrokes, vlines);
+  PLUS_LAP(merge);
+  PLUS_STAT_ADD(vlines, vlines.size());
+  PLUS_STAT_ADD(hlines, hlines.size());
+
+  // O((V + H) log V) sweep instead of the O(V*H) window scan
+  long long nplus = count_crossings_sweep(hlines, vlines);
+  PLUS_LAP(count);
+  PLUS_STAT_ADD(crossings, nplus);
+  PLUS_STATS_END("sweep_fenwick");
+  return nplus;
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // A zero-length vertical line on a horizontal one
+  N = 3;
+  L = {1, 0, 1};
+  D = "RUR";
+  expected = 0;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "flat_hash.h"
+
+using namespace std;
+
+// Custom struct for coordinates
+struct Coord {
+  long long x, y;
+
+  bool operator==(const Coord &other) const {
+    return x == other.x && y == other.y;
+  }
+};
+
+// Hash function for Coord
+struct CoordHash {
+  size_t operator()(const Coord &coord) const {
+    return hash_combine(hash_mix(coord.x), coord.y);
+  }
+};
+
+// simple_idea finished: it marks every unit edge that is drawn instead of
+// every point, since points alone can't tell two strokes that touch from
+// one line. A vertical edge is keyed by its lower end and a horizontal edge
+// by its left end, and a point is a plus sign when the edges on all four
+// sides of it are drawn. Still one entry per unit of length, so long
+// strokes run out of memory.
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  long long nplus = 0, x = 0, y = 0, j = 0;
+  FlatHashSet<Coord, CoordHash> vertical_edges;
+  FlatHashSet<Coord, CoordHash> horizontal_edges;
+
+  for (int i = 0; i < N; i++) {
+    switch (D[i]) {
+    case 'U':
+      for (j = 0; j < L[i]; j++)
+        vertical_edges.insert(Coord{x, y++});
+      break;
+    case 'D':
+      for (j = 0; j < L[i]; j++)
+        vertical_edges.insert(Coord{x, --y});
+      break;
+    case 'L':
+      for (j = 0; j < L[i]; j++)
+        horizontal_edges.insert(Coord{--x, y});
+      break;
+    case 'R':
+      for (j = 0; j < L[i]; j++)
+        horizontal_edges.insert(Coord{x++, y});
+      break;
+    }
+  }
+
+  // Each point is visited once, through the vertical edge below it
+  for (const Coord &below : vertical_edges) {
+    Coord p{below.x, below.y + 1};
+    if (vertical_edges.contains(p) && horizontal_edges.contains(p) &&
+        horizontal_edges.contains(Coord{p.x - 1, p.y}))
+      nplus++;
+  }
+  return nplus;
+}
+
+int main() {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  return 0;
+}
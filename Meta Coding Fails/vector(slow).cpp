@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "plus_stats.h"
+
 using namespace std;
 
 struct Interval {
@@ -46,6 +49,7 @@ inline void merge_intervals(vector<Interval> &intervals,
 }
 
 long long getPlusSignCount(int N, vector<int> L, string D) {
+  PLUS_STATS_BEGIN();
   long long x = 0, y = 0, m = 0;
   vector<Interval> vstrokes, hstrokes, vlines, hlines;
   vstrokes.reserve(N);
@@ -77,13 +81,18 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
     }
     m = 0;
   }
+  PLUS_LAP(build);
+  PLUS_STAT_ADD(vstrokes, vstrokes.size());
+  PLUS_STAT_ADD(hstrokes, hstrokes.size());
   sort(hstrokes.begin(), hstrokes.end(),
        [](const Interval &lhs, const Interval &rhs) {
          if (lhs.a != rhs.a)
            return lhs.a < rhs.a;
          return lhs.s < rhs.s;
        });
+  PLUS_LAP(sort);
   merge_intervals(hstrokes, hlines);
+  PLUS_LAP(merge);
 
   sort(vstrokes.begin(), vstrokes.end(),
        [](const Interval &lhs, const Interval &rhs) {
@@ -91,13 +100,18 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
            return lhs.a < rhs.a;
          return lhs.s < rhs.s;
        });
+  PLUS_LAP(sort);
   merge_intervals(vstrokes, vlines);
+  PLUS_LAP(merge);
   sort(vlines.begin(), vlines.end(),
        [](const Interval &lhs, const Interval &rhs) {
          if (lhs.s != rhs.s)
            return lhs.s < rhs.s;
          return lhs.a < rhs.a;
        });
+  PLUS_LAP(sort);
+  PLUS_STAT_ADD(vlines, vlines.size());
+  PLUS_STAT_ADD(hlines, hlines.size());
 
   long long nplus = 0;
   long long h_idx = 0;
@@ -110,11 +124,15 @@ long long getPlusSignCount(int N, vector<int> L, string D) {
 
     // Check all horizontal lines that could intersect with current vertical
     for (long long i = h_idx; i < h_size && hlines[i].a < vline.e; i++) {
+      PLUS_STAT_ADD(candidates, 1);
       if (hlines[i].s < vline.a && vline.a < hlines[i].e) {
         nplus++;
       }
     }
   }
+  PLUS_LAP(count);
+  PLUS_STAT_ADD(crossings, nplus);
+  PLUS_STATS_END("vector");
   return nplus;
 }
 
@@ -0,0 +1,156 @@
+// Viewport counts with PlusIndex (plus_index.h).
+//
+//   g++ -std=c++17 -O2 -I. -o viewport_query viewport_query.cpp
+//   ./viewport_query [strokes] [queries]
+//
+// Runs the usual three cases and two with zero-length lines through a
+// whole-plane query, checks random viewports of small drawings against
+// listing the crossings, then times queries on one large drawing.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "drawing_gen.h"
+#include "plus_index.h"
+#include "plus_sign.h"
+
+using namespace std;
+
+// Far enough out that x - 1 can't overflow
+const long long FAR = 1LL << 62;
+
+void build_lines(int N, const vector<int> &L, const string &D,
+                 vector<Interval> &hlines, vector<Interval> &vlines) {
+  vector<Interval> vstrokes, hstrokes, scratch;
+  build_strokes(N, L, D, vstrokes, hstrokes);
+  sort_by_anchor_start(hstrokes, scratch);
+  merge_intervals(hstrokes, hlines);
+  sort_by_anchor_start(vstrokes, scratch);
+  merge_intervals(vstrokes, vlines);
+}
+
+long long getPlusSignCount(int N, vector<int> L, string D) {
+  vector<Interval> hlines, vlines;
+  build_lines(N, L, D, hlines, vlines);
+  PlusIndex index(hlines, vlines);
+  return index.count(-FAR, -FAR, FAR, FAR);
+}
+
+// Every crossing of a small drawing, for checking
+vector<pair<long long, long long>> list_crossings(const vector<Interval> &h,
+                                                  const vector<Interval> &v) {
+  vector<pair<long long, long long>> points;
+  for (const Interval &hl : h) {
+    for (const Interval &vl : v) {
+      if (hl.s < vl.a && vl.a < hl.e && vl.s < hl.a && hl.a < vl.e)
+        points.emplace_back(vl.a, hl.a);
+    }
+  }
+  return points;
+}
+
+int main(int argc, char **argv) {
+  int N = 9;
+  vector<int> L = {6, 3, 4, 5, 1, 6, 3, 3, 4};
+  string D = "ULDRULURD";
+  long long expected = 4;
+  long long result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 1, 1, 1, 1, 1, 1, 1};
+  D = "RDLUULDR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 8;
+  L = {1, 2, 2, 1, 1, 2, 2, 1};
+  D = "UDUDLRLR";
+  expected = 1;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  // Zero-length lines, one vertical and one horizontal
+  N = 3;
+  L = {2, 1, 0};
+  D = "RLU";
+  expected = 0;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  N = 3;
+  L = {1, 0, 2};
+  D = "DLD";
+  expected = 0;
+  result = getPlusSignCount(N, L, D);
+  cout << "Expected: " << expected << ", Got: " << result << "\n\n\n";
+
+  int strokes = argc > 1 ? atoi(argv[1]) : 1000000;
+  size_t queries = argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000;
+
+  // Small drawings against the listed crossings
+  uint64_t state = 1;
+  auto next = [&]() {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state >> 33;
+  };
+  size_t mismatches = 0;
+  uint64_t seed = 1;
+  for (Shape shape : all_shapes) {
+    for (int i = 0; i < 40; i++) {
+      Drawing d = generate_drawing(shape, 1 + next() % 300, seed++);
+      vector<Interval> hlines, vlines;
+      build_lines(d.N, d.L, d.D, hlines, vlines);
+      PlusIndex index(hlines, vlines);
+      vector<pair<long long, long long>> points =
+          list_crossings(hlines, vlines);
+      for (int q = 0; q < 50; q++) {
+        long long x1 = (long long)(next() % 400) - 200, x2 = x1 + next() % 200;
+        long long y1 = (long long)(next() % 400) - 200, y2 = y1 + next() % 200;
+        long long want = 0;
+        for (const auto &[x, y] : points)
+          want += x1 <= x && x <= x2 && y1 <= y && y <= y2;
+        mismatches += index.count(x1, y1, x2, y2) != want;
+      }
+    }
+  }
+  cout << "Mismatches against listed crossings: " << mismatches << "\n";
+
+  Drawing d = generate_drawing(Shape::random_walk, strokes, 1);
+  vector<Interval> hlines, vlines;
+  build_lines(d.N, d.L, d.D, hlines, vlines);
+  auto start = chrono::steady_clock::now();
+  PlusIndex index(hlines, vlines);
+  double build_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+  cout << "Built over " << hlines.size() + vlines.size() << " lines in "
+       << build_ms << " ms, " << index.node_count() << " nodes\n";
+
+  // Viewports a tenth of the drawing's size, anywhere on it
+  long long x_lo = FAR, x_hi = -FAR, y_lo = FAR, y_hi = -FAR;
+  for (const Interval &line : hlines) {
+    x_lo = min(x_lo, line.s);
+    x_hi = max(x_hi, line.e);
+    y_lo = min(y_lo, line.a);
+    y_hi = max(y_hi, line.a);
+  }
+  long long w = (x_hi - x_lo) / 10 + 1, h = (y_hi - y_lo) / 10 + 1;
+  long long total = 0;
+  start = chrono::steady_clock::now();
+  for (size_t q = 0; q < queries; q++) {
+    long long x = x_lo + (long long)(next() % (x_hi - x_lo + 1));
+    long long y = y_lo + (long long)(next() % (y_hi - y_lo + 1));
+    total += index.count(x, y, x + w, y + h);
+  }
+  double query_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+          .count();
+  cout << queries << " viewport queries in " << query_ms << " ms ("
+       << total << " plus signs)\n";
+  return mismatches != 0;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fork/join on a fixed set of threads.
+//
+//   WorkStealingPool pool(threads);
+//   pool.run([&] {
+//     pool.fork_join([&] { left(); }, [&] { right(); });
+//   });
+//
+// run() makes the calling thread worker 0 for the length of the call. Every
+// worker keeps a deque of forked tasks: it pushes and pops its own at the
+// back, newest first, and an idle worker steals the oldest task from the
+// front of someone else's, which for a recursion is the biggest piece left.
+// A worker waiting on a stolen task runs other tasks meanwhile instead of
+// blocking.
+//
+// Tasks live on the forking thread's stack until they are joined, so the
+// pool never allocates per fork. They must not throw. fork_join called
+// outside run() just runs both sides in order.
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(unsigned threads)
+      : count(threads > 0 ? threads : 1), queues(new Queue[count]) {
+    for (unsigned i = 1; i < count; i++)
+      workers.emplace_back([this, i] { work(i); });
+  }
+
+  ~WorkStealingPool() {
+    {
+      std::lock_guard<std::mutex> lock(state);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  unsigned size() const { return count; }
+
+  // Runs f on the calling thread with the other workers stealing its forks.
+  // One run at a time; a second caller waits.
+  template <class F> void run(F &&f) {
+    std::lock_guard<std::mutex> one(run_lock);
+    const Current saved = current();
+    current() = {this, 0};
+    {
+      std::lock_guard<std::mutex> lock(state);
+      running = true;
+    }
+    wake.notify_all();
+    f();
+    {
+      std::lock_guard<std::mutex> lock(state);
+      running = false;
+    }
+    current() = saved;
+  }
+
+  // Runs a and b, maybe in parallel, and returns once both have finished
+  template <class A, class B> void fork_join(A &&a, B &&b) {
+    if (current().pool != this) {
+      a();
+      b();
+      return;
+    }
+    const unsigned self = current().index;
+    Task task;
+    task.fn = &b;
+    task.call = [](void *fn) {
+      (*static_cast<std::remove_reference_t<B> *>(fn))();
+    };
+    push(self, &task);
+    a();
+    // Everything a forked has been joined, so b is at the back unless it
+    // was stolen
+    if (pop_if(self, &task)) {
+      b();
+      return;
+    }
+    while (!task.done.load(std::memory_order_acquire))
+      if (!run_one(self))
+        std::this_thread::yield();
+  }
+
+private:
+  struct Task {
+    void (*call)(void *) = nullptr;
+    void *fn = nullptr;
+    std::atomic<bool> done{false};
+  };
+
+  struct Queue {
+    std::mutex lock;
+    std::deque<Task *> tasks;
+  };
+
+  struct Current {
+    WorkStealingPool *pool;
+    unsigned index;
+  };
+
+  static Current &current() {
+    static thread_local Current c{nullptr, 0};
+    return c;
+  }
+
+  const unsigned count;
+  std::unique_ptr<Queue[]> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex run_lock;
+  std::mutex state;
+  std::condition_variable wake;
+  std::atomic<bool> running{false};
+  bool stopping = false;
+
+  void push(unsigned self, Task *task) {
+    std::lock_guard<std::mutex> lock(queues[self].lock);
+    queues[self].tasks.push_back(task);
+  }
+
+  bool pop_if(unsigned self, Task *task) {
+    std::lock_guard<std::mutex> lock(queues[self].lock);
+    std::deque<Task *> &tasks = queues[self].tasks;
+    if (tasks.empty() || tasks.back() != task)
+      return false;
+    tasks.pop_back();
+    return true;
+  }
+
+  // Own newest task, or else the oldest one of the next busy worker
+  Task *take(unsigned self) {
+    for (unsigned k = 0; k < count; k++) {
+      Queue &queue = queues[(self + k) % count];
+      std::lock_guard<std::mutex> lock(queue.lock);
+      if (queue.tasks.empty())
+        continue;
+      Task *task;
+      if (k == 0) {
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+      } else {
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+      }
+      return task;
+    }
+    return nullptr;
+  }
+
+  bool run_one(unsigned self) {
+    Task *task = take(self);
+    if (task == nullptr)
+      return false;
+    task->call(task->fn);
+    // The forker may return as soon as it sees this, taking the task with it
+    task->done.store(true, std::memory_order_release);
+    return true;
+  }
+
+  void work(unsigned self) {
+    current() = {this, self};
+    std::unique_lock<std::mutex> lock(state);
+    for (;;) {
+      wake.wait(lock, [&] { return stopping || running.load(); });
+      if (stopping)
+        return;
+      lock.unlock();
+      while (running.load(std::memory_order_acquire))
+        if (!run_one(self))
+          std::this_thread::yield();
+      lock.lock();
+    }
+  }
+};